@@ -0,0 +1,54 @@
+/*******************************************************************************
+*                            Allocation Counters
+********************************************************************************
+* Notes: Counts the calls to malloc(), calloc() and realloc() made by the
+* simulator and the bytes they request, per thread, e.g. to report the
+* allocations per event of a benchmark. The three functions are redirected by
+* macros, so this header must be included after <stdlib.h> and before the
+* headers whose allocations are counted (engine.h does it).
+*******************************************************************************/
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stdlib.h>             // Needed for malloc(), calloc() and realloc()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+static _Thread_local unsigned long allocCount;  // Allocations of this thread
+static _Thread_local unsigned long allocBytes;  // Bytes requested by this thread
+
+/*******************************************************************************
+*       countMalloc(size_t bytes) / countCalloc(size_t n, size_t size)
+*       countRealloc(void *ptr, size_t bytes)
+********************************************************************************
+* Functions that count an allocation, then make it
+* - Input: arguments of malloc(), calloc() and realloc()
+* - Output: void* (allocated memory, NULL on failure)
+*******************************************************************************/
+static inline void *countMalloc(size_t bytes)
+{
+    allocCount++;
+    allocBytes += bytes;
+    return malloc(bytes);
+}
+
+static inline void *countCalloc(size_t n, size_t size)
+{
+    allocCount++;
+    allocBytes += n * size;
+    return calloc(n, size);
+}
+
+static inline void *countRealloc(void *ptr, size_t bytes)
+{
+    allocCount++;
+    allocBytes += bytes;
+    return realloc(ptr, bytes);
+}
+
+#define malloc(bytes)       countMalloc(bytes)
+#define calloc(n, size)     countCalloc(n, size)
+#define realloc(ptr, bytes) countRealloc(ptr, bytes)
+
+#endif
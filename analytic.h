@@ -0,0 +1,265 @@
+/*******************************************************************************
+*                        Closed Forms of Markovian Queues
+********************************************************************************
+* Notes: Steady-state outputs of the models that have a closed form, to answer
+* a point without simulating it (--analytic) or to check a simulation against
+* theory (--validate):
+*   M/M/c       one FCFS queue (Erlang C); M/M/1 is the case c = 1
+*   M/M/1/K     one server, at most K customers (arrivals beyond are lost)
+*   c x M/M/1   c servers with a queue each, jobs sent to one at random
+*               (Poisson splitting: c independent M/M/1 at rate lambda/c)
+* Rates and times are in the unit of the model. The response time quantiles
+* are found by bisection on the closed-form survival function.
+*------------------------------------------------------------------------------*
+* Usage:
+*   Theory t;
+*   if (theoryMMc(1.0 / arrTime, 1.0 / servTime, c, &t))
+*       printf("%f\n", t.sojourn);
+*******************************************************************************/
+#ifndef ANALYTIC_H
+#define ANALYTIC_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for malloc() and exit()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for exp(), log() and pow()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define THEORY_QUANTILES   3    // Response time quantiles (p50, p99, p99.9)
+#define THEORY_ITERATIONS  200  // Steps of the bisection of a quantile
+
+static const double theoryQuantiles[THEORY_QUANTILES] = { 0.50, 0.99, 0.999 };
+
+typedef struct Theory {         // Steady-state outputs of a model
+    double throughput;          // Customers served per unit of time
+    double allBusy;             // Probability that every server is busy
+    double customers;           // Mean number of customers in the system
+    double sojourn;             // Mean response time
+    double busy;                // Utilization of each server
+    double blocking;            // Probability that an arrival is lost
+    double waiting;             // Probability that an admitted customer waits
+    double idleRate;            // Idle periods of a server are exponential
+                                // with this rate (NAN if they are not)
+    double response[THEORY_QUANTILES];  // Quantiles of the response time
+} Theory;
+
+typedef struct Survival {       // Survival function of the response time
+    double mu;                  // Service rate
+    double wait;                // M/M/c: probability of waiting
+    double theta;               // M/M/c: rate of the wait (c*mu - lambda)
+    int k;                      // M/M/1/K: capacity (0 for M/M/c)
+    double *tail;               // M/M/1/K: P(admitted customer finds >= j)
+} Survival;
+
+/*******************************************************************************
+*       erlangC(int c, double a)
+********************************************************************************
+* Function that computes the probability of waiting of an M/M/c queue, through
+* the Erlang B recursion (stable for thousands of servers)
+* - Input: c (number of servers)
+*           a (offered load lambda/mu, below c)
+* - Output: double (probability that an arrival waits)
+*******************************************************************************/
+double erlangC(int c, double a)
+{
+    double b = 1.0;     // Erlang B with 0 servers
+
+    for (int k = 1; k <= c; k++)
+        b = a * b / (k + a * b);
+    return b / (1.0 - (a / c) * (1.0 - b));
+}
+
+/*******************************************************************************
+*       survival(const Survival *s, double t)
+********************************************************************************
+* Function that computes P(response time > t)
+*   M/M/c:   no wait, or an Exp(theta) wait, then an Exp(mu) service
+*   M/M/1/K: an admitted customer that finds j customers stays an
+*            Erlang(j + 1, mu), i.e. longer than t iff fewer than j + 1
+*            services end by t: sum_j P(Poisson(mu t) = j) P(finds >= j)
+* - Input: *s (parameters of the model)
+*           t (time)
+* - Output: double (probability)
+*******************************************************************************/
+double survival(const Survival *s, double t)
+{
+    double mt = s->mu * t;
+
+    if (s->k == 0)
+    {
+        double both;
+        if (fabs(s->theta - s->mu) < 1e-9 * s->mu)
+            both = (1.0 + mt) * exp(-mt);
+        else
+            both = (s->theta * exp(-mt) - s->mu * exp(-s->theta * t)) / (s->theta - s->mu);
+        return (1.0 - s->wait) * exp(-mt) + s->wait * both;
+    }
+
+    if (mt <= 0)
+        return 1.0;
+    double sum = 0.0, logPois = -mt;    // log P(Poisson(mu t) = j)
+    for (int j = 0; j < s->k; j++)
+    {
+        if (j > 0)
+            logPois += log(mt / j);
+        sum += exp(logPois) * s->tail[j];
+    }
+    return sum;
+}
+
+/*******************************************************************************
+*       theoryResponse(const Survival *s, double mean, Theory *t)
+********************************************************************************
+* Function that finds the quantiles of the response time by bisection
+* - Input: *s (survival function)
+*           mean (mean response time, to bracket the quantiles)
+* - Output: t->response
+*******************************************************************************/
+void theoryResponse(const Survival *s, double mean, Theory *t)
+{
+    for (int q = 0; q < THEORY_QUANTILES; q++)
+    {
+        double target = 1.0 - theoryQuantiles[q];
+        double lo = 0.0, hi = mean;
+
+        while (survival(s, hi) > target)
+            hi *= 2;
+        for (int i = 0; i < THEORY_ITERATIONS && hi - lo > 1e-12 * hi; i++)
+        {
+            double mid = 0.5 * (lo + hi);
+            if (survival(s, mid) > target)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        t->response[q] = 0.5 * (lo + hi);
+    }
+}
+
+/*******************************************************************************
+*       theoryMMc(double lambda, double mu, int c, Theory *t)
+********************************************************************************
+* Function that computes the outputs of an M/M/c FCFS queue
+* - Input: lambda (arrival rate)
+*           mu (service rate of a server)
+*           c (number of servers)
+* - Output: *t (outputs)
+*           bool (false if the queue is unstable, lambda >= c mu)
+*******************************************************************************/
+bool theoryMMc(double lambda, double mu, int c, Theory *t)
+{
+    double a = lambda / mu, rho = a / c;
+
+    if (rho >= 1.0)
+        return false;
+    double wait = erlangC(c, a);
+    Survival s = { mu, wait, c * mu - lambda, 0, NULL };
+
+    t->throughput = lambda;
+    t->allBusy = wait;
+    t->customers = wait * rho / (1.0 - rho) + a;
+    t->sojourn = t->customers / lambda;
+    t->busy = rho;
+    t->blocking = 0.0;
+    t->waiting = wait;
+    t->idleRate = (c == 1) ? lambda : NAN;  // Random choice among idle servers
+    theoryResponse(&s, t->sojourn, t);
+    return true;
+}
+
+/*******************************************************************************
+*       theorySplit(double lambda, double mu, int c, Theory *t)
+********************************************************************************
+* Function that computes the outputs of c M/M/1 queues fed at random
+* - Input: lambda (total arrival rate)
+*           mu (service rate of a server)
+*           c (number of servers)
+* - Output: *t (outputs)
+*           bool (false if the queues are unstable, lambda >= c mu)
+*******************************************************************************/
+bool theorySplit(double lambda, double mu, int c, Theory *t)
+{
+    if (!theoryMMc(lambda / c, mu, 1, t))
+        return false;
+    t->throughput = lambda;
+    t->allBusy = pow(t->busy, c);   // The servers are independent
+    t->customers *= c;
+    return true;
+}
+
+/*******************************************************************************
+*       theoryMM1K(double lambda, double mu, int k, Theory *t)
+********************************************************************************
+* Function that computes the outputs of an M/M/1/K queue (stable at any load)
+* - Input: lambda (arrival rate)
+*           mu (service rate)
+*           k (capacity, customers in service included)
+* - Output: *t (outputs)
+*           bool (false if k < 1)
+*******************************************************************************/
+bool theoryMM1K(double lambda, double mu, int k, Theory *t)
+{
+    double rho = lambda / mu;
+    double sum = 0.0, customers = 0.0;
+
+    if (k < 1)
+        return false;
+    double *pi = (double*)malloc((k + 1) * sizeof(double));
+    double *tail = (double*)malloc((k + 1) * sizeof(double));
+    if (!pi || !tail) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    // pi_n proportional to rho^n, scaled by the largest term to avoid overflow
+    for (int n = 0; n <= k; n++)
+    {
+        pi[n] = (rho <= 1.0) ? pow(rho, n) : pow(1.0 / rho, k - n);
+        sum += pi[n];
+    }
+    for (int n = 0; n <= k; n++)
+    {
+        pi[n] /= sum;
+        customers += n * pi[n];
+    }
+    // Customers an admitted arrival finds: pi_n / (1 - pi_k), n < k
+    tail[k] = 0.0;
+    for (int n = k - 1; n >= 0; n--)
+        tail[n] = tail[n + 1] + pi[n] / (1.0 - pi[k]);
+    Survival s = { mu, 0.0, 0.0, k, tail };
+
+    t->blocking = pi[k];
+    t->throughput = lambda * (1.0 - pi[k]);
+    t->allBusy = 1.0 - pi[0];
+    t->customers = customers;
+    t->sojourn = customers / t->throughput;
+    t->busy = 1.0 - pi[0];
+    t->waiting = tail[1];
+    t->idleRate = lambda;
+    theoryResponse(&s, t->sojourn, t);
+    free(pi);
+    free(tail);
+    return true;
+}
+
+/*******************************************************************************
+*       theoryIdleBelow(const Theory *t, double edge)
+********************************************************************************
+* Function that computes the fraction of the idle time of a server spent in
+* idle periods shorter than edge (time-weighted, like EdgeDistr). For
+* Exp(r) periods it is 1 - e^(-r x) (1 + r x).
+* - Input: *t (outputs of the model)
+*           edge (length of the idle periods)
+* - Output: double (fraction, NAN if the idle periods are not exponential)
+*******************************************************************************/
+double theoryIdleBelow(const Theory *t, double edge)
+{
+    double x = t->idleRate * edge;
+
+    if (isinf(x))
+        return 1.0;
+    return 1.0 - exp(-x) * (1.0 + x);
+}
+
+#endif
@@ -0,0 +1,266 @@
+/*******************************************************************************
+*                           Arrival Processes
+********************************************************************************
+* Notes: Draws the arrival times of a run from a process chosen with -A, always
+* with the mean time between arrivals given to -a (so the load is unchanged,
+* only its burstiness is); times are in the unit of -a:
+*   poisson             Poisson arrivals (default)
+*   mmpp:ratio:hold     Markov-modulated Poisson process of two states of
+*                       equal mean holding time, the rate of one ratio times
+*                       the rate of the other
+*   onoff:on:off        bursts: Poisson arrivals during on periods, none
+*                       during off periods (exponential, of these means)
+*   sine:amp:period     rate (1 + amp sin(2 pi t / period)) / mean, amp <= 1
+*   steps:period:m1,m2,...  rate mi / mean during slot i of a repeating
+*                       period cut in equal slots (e.g. 24 slots of a day),
+*                       the mi are scaled to an average of 1
+* The MMPP and on/off draw the next arrival of their state and the end of the
+* state, and keep the earlier one (both are exponential). The sinusoid is
+* thinned from a Poisson process at its peak rate (a candidate is kept with
+* probability rate/peak, so on average 1/(1 + amp) candidates per arrival).
+* The steps are drawn by inversion: a unit of cumulative rate is spent slot
+* by slot, with no rejection.
+*------------------------------------------------------------------------------*
+* Usage:
+*   ArrivalSpec spec;
+*   Arrivals a;
+*   parseArrival("onoff:100:900", &spec);
+*   arrivalInit(&a, &spec, mean, &streams[STREAM_ARRIVAL]);
+*   nextArrival = arrivalNext(&a, time);
+*******************************************************************************/
+#ifndef ARRIVAL_H
+#define ARRIVAL_H
+
+#include <stdio.h>              // Needed for snprintf()
+#include <stdlib.h>             // Needed for strtod()
+#include <string.h>             // Needed for strncmp(), strlen() and memset()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for sin(), floor() and INFINITY
+#include "rng.h"                // Needed for Rng and rngUniform()
+#include "utils.h"              // Needed for ExpStream and expntl()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define ARRIVAL_STEPS  96       // Maximum number of slots of a rate curve
+
+enum {                          // Arrival processes
+    ARRIVAL_POISSON,
+    ARRIVAL_MMPP,
+    ARRIVAL_ONOFF,
+    ARRIVAL_SINE,
+    ARRIVAL_STEPS_CURVE,
+    NUM_ARRIVALS
+};
+
+static const char *arrivalNames[NUM_ARRIVALS] = {
+    "poisson", "mmpp", "onoff", "sine", "steps" };
+
+typedef struct ArrivalSpec {    // Arrival process chosen on the command line
+    int type;                   // ARRIVAL_*
+    double x, y;                // Its two parameters (see the notes above)
+    int n;                      // Slots of the rate curve (steps)
+    double m[ARRIVAL_STEPS];    // Rate of each slot, average 1 (steps)
+    char name[64];              // As given to -A, e.g. "onoff:100:900"
+} ArrivalSpec;
+
+typedef struct Arrivals {       // State of the arrival process of a run
+    int type;                   // ARRIVAL_*
+    double mean;                // Mean time between arrivals
+    ExpStream es;               // Block of unit exponentials
+    Rng *rng;                   // Random stream of the blocks and the thinning
+    double rate[2];             // Rate of each state (mmpp, onoff)
+    double hold[2];             // Mean holding time of each state (mmpp, onoff)
+    int state;                  // Current state (mmpp, onoff)
+    double switchTime;          // End of the current state (mmpp, onoff)
+    double amp, period;         // Amplitude and period (sine, steps)
+    const ArrivalSpec *spec;    // Rate curve (steps)
+} Arrivals;
+
+/*******************************************************************************
+*       parseArrival(const char *arg, ArrivalSpec *spec)
+********************************************************************************
+* Function that parses an arrival process "name" or "name:x:y"
+* - Input: arg (arrival process, see the notes above)
+* - Output: *spec (parsed arrival process)
+*           bool (false if the name is unknown or a parameter is invalid)
+*******************************************************************************/
+bool parseArrival(const char *arg, ArrivalSpec *spec)
+{
+    const char *colon = strchr(arg, ':');
+    size_t len = colon ? (size_t)(colon - arg) : strlen(arg);
+    char *end;
+
+    memset(spec, 0, sizeof(*spec));     // Compared bytewise by the checkpoints
+    spec->type = -1;
+    for (int i = 0; i < NUM_ARRIVALS; i++)
+        if (strlen(arrivalNames[i]) == len && strncmp(arg, arrivalNames[i], len) == 0)
+            spec->type = i;
+    if (spec->type < 0)
+        return false;
+    snprintf(spec->name, sizeof(spec->name), "%s", arg);
+    if (spec->type == ARRIVAL_POISSON)
+        return colon == NULL;
+    if (!colon)
+        return false;
+
+    spec->x = strtod(colon + 1, &end);
+    if (*end != ':')
+        return false;
+    if (spec->type == ARRIVAL_STEPS_CURVE)
+    {
+        double sum = 0.0;
+        const char *at = end + 1;
+
+        for (spec->n = 0; spec->n < ARRIVAL_STEPS; spec->n++)
+        {
+            spec->m[spec->n] = strtod(at, &end);
+            if (end == at || spec->m[spec->n] < 0)
+                return false;
+            sum += spec->m[spec->n];
+            if (*end != ',')
+                break;
+            at = end + 1;
+        }
+        if (*end != '\0' || sum <= 0)
+            return false;
+        spec->n++;
+        for (int i = 0; i < spec->n; i++)
+            spec->m[i] *= spec->n / sum;
+        return spec->x > 0;
+    }
+    spec->y = strtod(end + 1, &end);
+    if (*end != '\0')
+        return false;
+
+    switch (spec->type) {
+        case ARRIVAL_MMPP:
+            return spec->x >= 1 && spec->y > 0;
+        case ARRIVAL_ONOFF:
+            return spec->x > 0 && spec->y > 0;
+        case ARRIVAL_SINE:
+            return spec->x >= 0 && spec->x <= 1 && spec->y > 0;
+    }
+    return false;
+}
+
+/*******************************************************************************
+*       arrivalInit(Arrivals *a, const ArrivalSpec *spec, double mean, Rng *rng)
+********************************************************************************
+* Function that sets up an arrival process of the given mean time between
+* arrivals, in its stationary state at time 0
+* - Input: *a (arrival process to initialize)
+*           *spec (arrival process, must outlive a)
+*           mean (mean time between arrivals)
+*           *rng (random stream to draw from, must outlive a)
+*******************************************************************************/
+void arrivalInit(Arrivals *a, const ArrivalSpec *spec, double mean, Rng *rng)
+{
+    a->type = spec->type;
+    a->mean = mean;
+    a->rng = rng;
+    a->spec = spec;
+    a->state = 0;
+    a->switchTime = INFINITY;
+    a->amp = spec->x;
+    a->period = spec->y;
+    expInit(&a->es, rng);
+
+    switch (spec->type) {
+        case ARRIVAL_MMPP:      // (rate[0] + rate[1]) / 2 = 1 / mean
+            a->rate[0] = 2.0 / ((1.0 + spec->x) * mean);
+            a->rate[1] = spec->x * a->rate[0];
+            a->hold[0] = a->hold[1] = spec->y;
+            break;
+        case ARRIVAL_ONOFF:     // On a fraction on / (on + off) of the time
+            a->rate[0] = 0.0;
+            a->rate[1] = (spec->x + spec->y) / (spec->x * mean);
+            a->hold[0] = spec->y;
+            a->hold[1] = spec->x;
+            break;
+        case ARRIVAL_STEPS_CURVE:
+            a->period = spec->x;
+            break;
+    }
+    if (spec->type == ARRIVAL_MMPP || spec->type == ARRIVAL_ONOFF)
+    {
+        a->state = rngUniform(rng) * (a->hold[0] + a->hold[1]) >= a->hold[0];
+        a->switchTime = expntl(&a->es, a->hold[a->state]);
+    }
+}
+
+/*******************************************************************************
+*       arrivalModulated(Arrivals *a, double time)
+********************************************************************************
+* Function that draws the next arrival of a process other than Poisson
+* - Input: *a (arrival process)
+*           time (time of the last arrival)
+* - Output: double (time of the next arrival)
+*******************************************************************************/
+double arrivalModulated(Arrivals *a, double time)
+{
+    switch (a->type) {
+        case ARRIVAL_MMPP:
+        case ARRIVAL_ONOFF:
+            for (;;)
+            {
+                double next = (a->rate[a->state] > 0)
+                              ? time + expntl(&a->es, 1.0 / a->rate[a->state]) : INFINITY;
+                if (next < a->switchTime)
+                    return next;
+                time = a->switchTime;   // The state ends first, draw again from there
+                a->state ^= 1;
+                a->switchTime = time + expntl(&a->es, a->hold[a->state]);
+            }
+        case ARRIVAL_SINE:
+            for (;;)
+            {
+                time += expntl(&a->es, a->mean / (1.0 + a->amp));
+                if (rngUniform(a->rng) * (1.0 + a->amp) <= 1.0 + a->amp * sin(2.0 * M_PI * time / a->period))
+                    return time;
+            }
+        case ARRIVAL_STEPS_CURVE:
+        {
+            const ArrivalSpec *spec = a->spec;
+            double slot = a->period / spec->n;
+            double need = expntl(&a->es, a->mean);  // Cumulative rate to spend
+            double cycle = floor(time / a->period) * a->period;
+            int i = (int)((time - cycle) / slot);
+
+            for (;;)
+            {
+                if (i >= spec->n)
+                {
+                    i = 0;
+                    cycle += a->period;
+                }
+                double end = cycle + (i + 1) * slot;
+                double rest = spec->m[i] * (end - time);
+                if (rest >= need && spec->m[i] > 0)
+                    return time + need / spec->m[i];
+                need -= rest;
+                time = end;
+                i++;
+            }
+        }
+    }
+    return INFINITY;
+}
+
+/*******************************************************************************
+*       arrivalNext(Arrivals *a, double time)
+********************************************************************************
+* Function that draws the next arrival (Poisson inline, the same variates as
+* expntl() on its own)
+* - Input: *a (arrival process)
+*           time (time of the last arrival)
+* - Output: double (time of the next arrival)
+*******************************************************************************/
+static inline double arrivalNext(Arrivals *a, double time)
+{
+    if (a->type == ARRIVAL_POISSON)
+        return time + expntl(&a->es, a->mean);
+    return arrivalModulated(a, time);
+}
+
+#endif
@@ -0,0 +1,217 @@
+/*******************************************************************************
+*                          Throughput Benchmarks
+********************************************************************************
+* Notes: Measures a workload (one simulation run) in a forked child, so that
+* every measure belongs to that run alone: wall-clock time, events, peak
+* resident set size and allocations (see alloc.h). The child sends its
+* measures back through a pipe. A workload is run BENCH_REPEATS times and the
+* fastest run is kept, which filters out most of the noise of a shared machine.
+*
+* A benchmark written as JSON lines (-f json) can be loaded as the baseline
+* of a later one; the points are matched by model, load and servers, and a
+* point whose ns/event grew by more than BENCH_TOLERANCE is a regression.
+*------------------------------------------------------------------------------*
+* Usage:
+*   BenchResult r;
+*   benchMeasure(runPoint, &point, &r);     // r.events / r.seconds ...
+*   BenchBase base;
+*   benchLoad("baseline.json", &base);
+*   old = benchFind(&base, "mmc", 0.9, 64);  // NAN if the point is missing
+*******************************************************************************/
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>              // Needed for FILE and printf()
+#include <stdlib.h>             // Needed for strtod() and exit()
+#include <string.h>             // Needed for strstr() and strcmp()
+#include <math.h>               // Needed for NAN and fabs()
+#include <unistd.h>             // Needed for fork() and pipe()
+#include <sys/wait.h>           // Needed for waitpid()
+#include <sys/resource.h>       // Needed for getrusage()
+#include "alloc.h"              // Needed for allocCount and allocBytes
+#include "checkpoint.h"         // Needed for wallTime()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define BENCH_EVENTS   1000000  // Events simulated per point (about)
+#define BENCH_REPEATS  3        // Runs of a point, the fastest is kept
+#define BENCH_TOLERANCE 0.10    // Growth of ns/event reported as a regression
+#define BENCH_MAX      1024     // Maximum number of points of a baseline
+#define BENCH_LINE     4096     // Longest line of a baseline
+
+typedef unsigned long (*BenchFunc)(void *ctx);  // Runs a workload, returns its events
+
+typedef struct BenchResult {    // Measures of one workload
+    unsigned long events;       // Events simulated
+    double seconds;             // Wall-clock time
+    long peakRss;               // Peak resident set size (KB)
+    unsigned long allocs;       // Calls to malloc(), calloc() and realloc()
+    unsigned long allocBytes;   // Bytes they requested
+} BenchResult;
+
+typedef struct BenchPoint {     // Point of a baseline
+    char model[16];
+    double load;
+    int servers;
+    double nsPerEvent;
+} BenchPoint;
+
+typedef struct BenchBase {      // Points of a baseline
+    int n;
+    BenchPoint at[BENCH_MAX];
+} BenchBase;
+
+/*******************************************************************************
+*       benchRun(BenchFunc fn, void *ctx, BenchResult *r)
+********************************************************************************
+* Function that runs fn(ctx) once in a child process and measures it
+* - Input: fn (workload)
+*           ctx (argument of the workload)
+* - Output: *r (measures of the workload)
+*******************************************************************************/
+void benchRun(BenchFunc fn, void *ctx, BenchResult *r)
+{
+    int fds[2];
+    int status;
+
+    fflush(stdout);
+    if (pipe(fds) != 0) {
+        printf("Cannot create a pipe!\n");
+        exit(EXIT_FAILURE);
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        printf("Cannot fork!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0)
+    {
+        struct rusage usage;
+        double start;
+
+        close(fds[0]);
+        allocCount = 0;
+        allocBytes = 0;
+        start = wallTime();
+        r->events = fn(ctx);
+        r->seconds = wallTime() - start;
+        r->allocs = allocCount;
+        r->allocBytes = allocBytes;
+        getrusage(RUSAGE_SELF, &usage);
+        r->peakRss = usage.ru_maxrss;
+        if (write(fds[1], r, sizeof(*r)) != sizeof(*r))
+            _exit(EXIT_FAILURE);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fds[1]);
+    ssize_t got = read(fds[0], r, sizeof(*r));
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+    if (got != sizeof(*r) || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+        printf("Benchmark run failed!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*******************************************************************************
+*       benchMeasure(BenchFunc fn, void *ctx, BenchResult *r)
+********************************************************************************
+* Function that runs fn(ctx) BENCH_REPEATS times and keeps the fastest run
+* - Input: fn (workload)
+*           ctx (argument of the workload)
+* - Output: *r (measures of the fastest run)
+*******************************************************************************/
+void benchMeasure(BenchFunc fn, void *ctx, BenchResult *r)
+{
+    BenchResult run;
+
+    benchRun(fn, ctx, r);
+    for (int i = 1; i < BENCH_REPEATS; i++)
+    {
+        benchRun(fn, ctx, &run);
+        if (run.seconds < r->seconds)
+            *r = run;
+    }
+}
+
+/*******************************************************************************
+*       jsonField(const char *line, const char *name)
+********************************************************************************
+* Function that finds the value of a field in a JSON line written by output.h
+* - Input: line (JSON object on one line)
+*           name (name of the field)
+* - Output: const char* (first character of the value, NULL if missing)
+*******************************************************************************/
+const char *jsonField(const char *line, const char *name)
+{
+    char key[64];
+    const char *at;
+
+    snprintf(key, sizeof(key), "\"%s\":", name);
+    at = strstr(line, key);
+    return at ? at + strlen(key) : NULL;
+}
+
+/*******************************************************************************
+*       benchLoad(const char *path, BenchBase *base)
+********************************************************************************
+* Function that loads the points of a benchmark written as JSON lines
+* - Input: path (baseline file)
+* - Output: *base (points of the baseline)
+*******************************************************************************/
+void benchLoad(const char *path, BenchBase *base)
+{
+    FILE *in = fopen(path, "r");
+    char line[BENCH_LINE];
+
+    if (!in) {
+        printf("Cannot open %s!\n", path);
+        exit(EXIT_FAILURE);
+    }
+    base->n = 0;
+    while (fgets(line, sizeof(line), in) && base->n < BENCH_MAX)
+    {
+        const char *model = jsonField(line, "model");
+        const char *load = jsonField(line, "load");
+        const char *servers = jsonField(line, "servers");
+        const char *ns = jsonField(line, "ns_per_event");
+        BenchPoint *pt = &base->at[base->n];
+
+        if (!model || !load || !servers || !ns || *model != '"')
+            continue;
+        size_t len = strcspn(model + 1, "\"");
+        if (len >= sizeof(pt->model))
+            continue;
+        memcpy(pt->model, model + 1, len);
+        pt->model[len] = '\0';
+        pt->load = strtod(load, NULL);
+        pt->servers = atoi(servers);
+        pt->nsPerEvent = strtod(ns, NULL);
+        base->n++;
+    }
+    fclose(in);
+}
+
+/*******************************************************************************
+*       benchFind(const BenchBase *base, const char *model, double load,
+*                 int servers)
+********************************************************************************
+* Function that finds the ns/event of a point in a baseline
+* - Input: *base (baseline)
+*           model, load, servers (point)
+* - Output: double (ns/event of the point, NAN if the baseline lacks it)
+*******************************************************************************/
+double benchFind(const BenchBase *base, const char *model, double load, int servers)
+{
+    for (int i = 0; i < base->n; i++)
+    {
+        const BenchPoint *pt = &base->at[i];
+        if (strcmp(pt->model, model) == 0 && fabs(pt->load - load) < 1e-9 && pt->servers == servers)
+            return pt->nsPerEvent;
+    }
+    return NAN;
+}
+
+#endif
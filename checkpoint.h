@@ -0,0 +1,362 @@
+/*******************************************************************************
+*                         Checkpoints of a Long Run
+********************************************************************************
+* Notes: Saves the complete state of a run (clock, queues, random streams,
+* accumulators and histograms) so that it can be resumed after a preemption,
+* or continued past its original -s, with exactly the results of an
+* uninterrupted run.
+*
+* A checkpoint is a compact binary file: the queues only hold their jobs and
+* the histograms only their non-empty buckets. It is written to path.tmp,
+* flushed to disk, then renamed over path, so a crash while writing leaves
+* the previous checkpoint intact.
+*
+* The same function serializes a structure in both directions (ckpt->saving),
+* so the save and the restore of a field can never drift apart.
+*------------------------------------------------------------------------------*
+* Usage:
+*   Ckpt ck;
+*   ckptOpen(&ck, "run.ckpt", true);        // false to restore
+*   ckptValue(&ck, time);
+*   ckptFifo(&ck, &queue);
+*   ckptClose(&ck);
+*******************************************************************************/
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>              // Needed for FILE, rename() and printf()
+#include <stdlib.h>             // Needed for exit()
+#include <string.h>             // Needed for memcmp()
+#include <stdbool.h>            // Needed for bool type
+#include <time.h>               // Needed for clock_gettime()
+#include <unistd.h>             // Needed for fsync()
+#include "fifo.h"               // Needed for Fifo
+#include "heap.h"               // Needed for DepHeap
+#include "idleset.h"            // Needed for IdleSet
+#include "histogram.h"          // Needed for Histogram and EdgeDistr
+#include "warmup.h"             // Needed for Series
+#include "utils.h"              // Needed for ExpStream
+#include "sampler.h"            // Needed for Sampler
+#include "arrival.h"            // Needed for Arrivals
+#include "cstate.h"             // Needed for CStates and CStateStats
+#include "pstate.h"             // Needed for PStates
+#include "dispatch.h"           // Needed for Dispatch
+#include "replay.h"             // Needed for Replay
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define CKPT_MAGIC     "QSIMCKP1"
+#define CKPT_INTERVAL  600      // Default seconds of wall-clock time between checkpoints
+#define CKPT_EVENTS    (1 << 20)    // Events between two looks at the clock
+#define CKPT_PATH      4096     // Longest checkpoint path
+
+typedef struct Ckpt {           // Checkpoint being saved or restored
+    FILE *file;
+    bool saving;                // true: save the state, false: restore it
+    char path[CKPT_PATH];       // Checkpoint
+    char tmp[CKPT_PATH + 4];    // File written before the rename
+} Ckpt;
+
+// Serialize a variable (not a pointer) in the direction of the checkpoint
+#define ckptValue(ck, x)    ckptBytes((ck), &(x), sizeof(x))
+
+/*******************************************************************************
+*       wallTime()
+********************************************************************************
+* Function that returns a monotonic wall-clock time
+* - Output: double (seconds)
+*******************************************************************************/
+double wallTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/*******************************************************************************
+*       ckptOpen(Ckpt *ck, const char *path, bool saving)
+********************************************************************************
+* Function that starts saving a checkpoint (to path.tmp) or restoring one
+* - Input: *ck (checkpoint to open)
+*           path (checkpoint file)
+*           saving (true to save, false to restore)
+*******************************************************************************/
+void ckptOpen(Ckpt *ck, const char *path, bool saving)
+{
+    char magic[8];
+
+    ck->saving = saving;
+    snprintf(ck->path, sizeof(ck->path), "%s", path);
+    snprintf(ck->tmp, sizeof(ck->tmp), "%s.tmp", path);
+    ck->file = fopen(saving ? ck->tmp : ck->path, saving ? "wb" : "rb");
+    if (!ck->file) {
+        printf("Cannot open %s!\n", saving ? ck->tmp : ck->path);
+        exit(EXIT_FAILURE);
+    }
+    if (saving)
+        fwrite(CKPT_MAGIC, 1, 8, ck->file);
+    else if (fread(magic, 1, 8, ck->file) != 8 || memcmp(magic, CKPT_MAGIC, 8) != 0) {
+        printf("%s is not a checkpoint!\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*******************************************************************************
+*       ckptBytes(Ckpt *ck, void *data, size_t bytes)
+********************************************************************************
+* Function that saves or restores a block of memory
+* - Input: *ck (checkpoint)
+*           data (memory to save, or to overwrite with the saved content)
+*           bytes (size of the block)
+*******************************************************************************/
+void ckptBytes(Ckpt *ck, void *data, size_t bytes)
+{
+    if (bytes == 0)
+        return;
+    if (ck->saving)
+    {
+        if (fwrite(data, 1, bytes, ck->file) != bytes) {
+            printf("Cannot write %s!\n", ck->tmp);
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (fread(data, 1, bytes, ck->file) != bytes) {
+        printf("%s is truncated!\n", ck->path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*******************************************************************************
+*       ckptCheck(Ckpt *ck, const void *data, size_t bytes)
+********************************************************************************
+* Function that saves a block, or checks that it matches the saved one (e.g.
+* the parameters a run cannot change when it is resumed)
+* - Input: *ck (checkpoint)
+*           data (block to save or compare)
+*           bytes (size of the block)
+* - Output: bool (false if the restored block differs)
+*******************************************************************************/
+bool ckptCheck(Ckpt *ck, const void *data, size_t bytes)
+{
+    char saved[bytes];
+
+    if (ck->saving)
+    {
+        ckptBytes(ck, (void*)data, bytes);
+        return true;
+    }
+    ckptBytes(ck, saved, bytes);
+    return memcmp(saved, data, bytes) == 0;
+}
+
+/*******************************************************************************
+*       ckptFifo(Ckpt *ck, Fifo *q)
+*       ckptHeap(Ckpt *ck, DepHeap *h)
+*       ckptIdle(Ckpt *ck, IdleSet *set)
+*       ckptCStates(Ckpt *ck, CStates *cs)
+*       ckptPStates(Ckpt *ck, PStates *ps)
+********************************************************************************
+* Functions that save or restore a queue (its values, oldest first), the
+* order of a heap (its keys belong to the caller), a set of idle servers, the
+* idle periods of the cores and their frequencies (their tables belong to the
+* caller). The structures must have been initialized with the same number of
+* servers, and a queue must be empty before it is restored.
+* - Input: *ck (checkpoint)
+*           *q / *h / *set / *cs / *ps (structure to save or restore)
+*******************************************************************************/
+void ckptFifo(Ckpt *ck, Fifo *q)
+{
+    unsigned int count = q->count;
+
+    ckptValue(ck, count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        double value = ck->saving ? q->items[(q->head + i) & q->mask] : 0.0;
+        ckptValue(ck, value);
+        if (!ck->saving)
+            fifoPush(q, value);
+    }
+}
+
+void ckptHeap(Ckpt *ck, DepHeap *h)
+{
+    ckptBytes(ck, h->heap, h->size * sizeof(int));
+    ckptBytes(ck, h->pos, h->size * sizeof(int));
+}
+
+void ckptIdle(Ckpt *ck, IdleSet *set)
+{
+    ckptValue(ck, set->count);
+    ckptBytes(ck, set->members, set->size * sizeof(int));
+    ckptBytes(ck, set->pos, set->size * sizeof(int));
+}
+
+void ckptCStates(Ckpt *ck, CStates *cs)
+{
+    ckptBytes(ck, cs->since, cs->c * sizeof(double));
+    ckptBytes(ck, cs->predict, cs->c * sizeof(double));
+}
+
+void ckptPStates(Ckpt *ck, PStates *ps)
+{
+    ckptBytes(ck, ps->util, ps->c * sizeof(double));
+    ckptBytes(ck, ps->last, ps->c * sizeof(double));
+    ckptBytes(ck, ps->level, ps->c * sizeof(int));
+}
+
+/*******************************************************************************
+*       ckptHistogram(Ckpt *ck, Histogram *h)
+*       ckptEdgeDistr(Ckpt *ck, EdgeDistr *d)
+*       ckptSeries(Ckpt *ck, Series *z)
+*       ckptCStateStats(Ckpt *ck, CStateStats *cst)
+********************************************************************************
+* Functions that save or restore a histogram (only its non-empty buckets), the
+* sums of an edge distribution (its edges belong to the caller), the batch
+* means of a series and the outputs of the idle states
+* - Input: *ck (checkpoint)
+*           *h / *d / *z / *cst (accumulator to save or restore)
+*******************************************************************************/
+void ckptHistogram(Ckpt *ck, Histogram *h)
+{
+    int used = 0;
+
+    ckptValue(ck, h->count);
+    ckptValue(ck, h->total);
+    ckptValue(ck, h->min);
+    ckptValue(ck, h->max);
+    if (ck->saving)
+    {
+        for (int i = 0; i < HIST_BUCKETS; i++)
+            used += (h->counts[i] != 0);
+    }
+    else
+    {
+        memset(h->counts, 0, sizeof(h->counts));
+        memset(h->sums, 0, sizeof(h->sums));
+    }
+    ckptValue(ck, used);
+    for (int i = 0, k = 0; k < used; i++)
+    {
+        int bucket = i;
+        if (ck->saving && h->counts[i] == 0)
+            continue;
+        ckptValue(ck, bucket);
+        if (bucket < 0 || bucket >= HIST_BUCKETS) {
+            printf("%s is corrupt!\n", ck->path);
+            exit(EXIT_FAILURE);
+        }
+        ckptValue(ck, h->counts[bucket]);
+        ckptValue(ck, h->sums[bucket]);
+        k++;
+    }
+}
+
+void ckptEdgeDistr(Ckpt *ck, EdgeDistr *d)
+{
+    ckptValue(ck, d->below);
+    ckptValue(ck, d->total);
+}
+
+void ckptSeries(Ckpt *ck, Series *z)
+{
+    ckptValue(ck, z->n);
+    if (z->n < 0 || z->n > SERIES_MAX) {
+        printf("%s is corrupt!\n", ck->path);
+        exit(EXIT_FAILURE);
+    }
+    ckptBytes(ck, z->z, z->n * sizeof(double));
+    ckptValue(ck, z->size);
+    ckptValue(ck, z->count);
+    ckptValue(ck, z->sum);
+}
+
+void ckptCStateStats(Ckpt *ck, CStateStats *cst)
+{
+    ckptValue(ck, cst->time);
+    ckptValue(ck, cst->wakes);
+    ckptValue(ck, cst->delayed);
+    ckptValue(ck, cst->latency);
+    ckptBytes(ck, cst->saved, cst->c * sizeof(double));
+}
+
+/*******************************************************************************
+*       ckptExp(Ckpt *ck, ExpStream *es)
+*       ckptSampler(Ckpt *ck, Sampler *s)
+*       ckptArrivals(Ckpt *ck, Arrivals *a)
+*       ckptDispatch(Ckpt *ck, Dispatch *ds)
+*       ckptReplay(Ckpt *ck, Replay *rp)
+********************************************************************************
+* Functions that save or restore the unused variates of a stream (its random
+* stream belongs to the caller), the state of an arrival process, the state of a dispatcher and the position
+* of a replayed log (with the jobs already read ahead)
+* - Input: *ck (checkpoint)
+*           *es / *s / *a / *ds / *rp (initialized structure to save or restore)
+*******************************************************************************/
+void ckptExp(Ckpt *ck, ExpStream *es)
+{
+    ckptValue(ck, es->next);
+    ckptValue(ck, es->v);
+}
+
+void ckptSampler(Ckpt *ck, Sampler *s)
+{
+    ckptValue(ck, s->next);
+    ckptValue(ck, s->v);
+}
+
+void ckptArrivals(Ckpt *ck, Arrivals *a)
+{
+    ckptExp(ck, &a->es);
+    ckptValue(ck, a->state);
+    ckptValue(ck, a->switchTime);
+}
+
+void ckptDispatch(Ckpt *ck, Dispatch *ds)
+{
+    ckptValue(ck, ds->next);
+    ckptBytes(ck, ds->length, ds->c * sizeof(double));
+    ckptBytes(ck, ds->workEnd, ds->c * sizeof(double));
+    ckptHeap(ck, &ds->shortest);
+    ckptHeap(ck, &ds->least);
+}
+
+void ckptReplay(Ckpt *ck, Replay *rp)
+{
+    ckptValue(ck, rp->pos);
+    ckptValue(ck, rp->line);
+    ckptValue(ck, rp->first);
+    ckptValue(ck, rp->last);
+    ckptValue(ck, rp->next);
+    ckptValue(ck, rp->count);
+    if (rp->count < 0 || rp->count > REPLAY_BLOCK || rp->pos > rp->size) {
+        printf("%s is corrupt!\n", ck->path);
+        exit(EXIT_FAILURE);
+    }
+    ckptBytes(ck, rp->arrival, rp->count * sizeof(double));
+    ckptBytes(ck, rp->service, rp->count * sizeof(double));
+}
+
+/*******************************************************************************
+*       ckptClose(Ckpt *ck)
+********************************************************************************
+* Function that finishes a checkpoint. A saved checkpoint is flushed to the
+* disk and atomically renamed over the previous one.
+* - Input: *ck (checkpoint to close)
+*******************************************************************************/
+void ckptClose(Ckpt *ck)
+{
+    if (!ck->saving)
+    {
+        fclose(ck->file);
+        return;
+    }
+    if (fflush(ck->file) != 0 || fsync(fileno(ck->file)) != 0 || fclose(ck->file) != 0
+        || rename(ck->tmp, ck->path) != 0) {
+        printf("Cannot write %s!\n", ck->path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+#endif
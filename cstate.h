@@ -0,0 +1,460 @@
+/*******************************************************************************
+*                           Core Idle States
+********************************************************************************
+* Notes: Power model of the idle states (C-states) of the cores. A table (-T)
+* lists the states from the shallowest to the deepest as
+* name:residency:latency:power, times in the unit of the model and power in W
+* per core; its first state is C0, the state of a running (or polling) core.
+* A core that goes idle enters a state chosen by the idle policy (-L):
+*   off         no idle states (the default, nothing is modelled)
+*   menu        the deepest state whose target residency is below the idle
+*               period predicted for the core (a moving average of its last
+*               idle periods), like the menu governor of Linux
+*   ladder      the shallowest state first, then one state deeper each time
+*               the idle period reaches the target residency of the next
+*   oracle      the deepest state whose target residency is below the actual
+*               idle period (a lower bound of the energy at no extra latency)
+*   timer       C0 first, then each state once the idle period reaches its
+*               target residency (the autonomous demotion of the hardware)
+*   <name>      always this state of the table, e.g. C6
+* The job that wakes the core starts after the exit latency of its state.
+* The package has states of its own (-U, same format, PC0 first), entered
+* with the timer policy while every core is idle (-K): the exit latency of
+* its state delays the job that ends the package idle period, on top of the
+* latency of its core, and its power is the uncore power of the package.
+* Idle periods are only known when they end, so a core is accounted for when
+* it wakes (or at the end of the run): the time in each state, the wake-ups,
+* the latency added to the jobs, and the energy each core saved against C0.
+*------------------------------------------------------------------------------*
+* Usage:
+*   CStates cs;
+*   cstateInit(&cs, &table, CPOLICY_MENU, 0, c);
+*   cstateSleep(&cs, core, time);                  // core goes idle
+*   delay = cstateWake(&cs, &cst, core, time, 0);  // job arrives on the core
+*******************************************************************************/
+#ifndef CSTATE_H
+#define CSTATE_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for calloc(), strtod() and exit()
+#include <string.h>             // Needed for strcmp() and strcspn()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for fmax()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define CSTATE_MAX     8        // Maximum number of states of a table (C0 included)
+#define CSTATE_NAME    8        // Longest name of a state (with its '\0')
+#define MENU_WEIGHT    0.25     // Weight of the last idle period in the prediction
+
+enum {                          // Idle policies
+    CPOLICY_OFF,
+    CPOLICY_MENU,
+    CPOLICY_LADDER,
+    CPOLICY_ORACLE,
+    CPOLICY_TIMER,
+    CPOLICY_FIXED,              // Named by the state
+    NUM_CPOLICIES
+};
+
+static const char *cpolicyNames[NUM_CPOLICIES] = {
+    "off", "menu", "ladder", "oracle", "timer", "fixed" };
+
+typedef struct CStateTable {    // Idle states of a core, C0 first
+    int n;                      // Number of states
+    char name[CSTATE_MAX][CSTATE_NAME];
+    double residency[CSTATE_MAX];   // Target residency (worth entering above it)
+    double latency[CSTATE_MAX];     // Exit latency
+    double power[CSTATE_MAX];       // Power of a core in the state (W)
+} CStateTable;
+
+typedef struct CStates {        // Idle states of the cores of a run
+    const CStateTable *t;       // States
+    int policy;                 // Idle policy (CPOLICY_*)
+    int fixed;                  // State of CPOLICY_FIXED, deepest of the others
+    int c;                      // Number of cores
+    double *since;              // Start of the idle period of each core
+    double *predict;            // Predicted idle period of each core (menu)
+} CStates;
+
+typedef struct CStateStats {    // Outputs of the idle states (summed over the cores)
+    int c;                      // Number of cores (length of saved)
+    double time[CSTATE_MAX];    // Idle time in each state (C0: polling)
+    unsigned long wakes[CSTATE_MAX];    // Wake-ups from each state
+    unsigned long delayed;      // Jobs delayed by an exit latency
+    double latency;             // Exit latency added to the jobs
+    double *saved;              // Energy saved against C0, per core (W x time)
+} CStateStats;
+
+/*******************************************************************************
+*       parseCStates(const char *arg, CStateTable *t)
+********************************************************************************
+* Function that parses a table of states "name:residency:latency:power,...",
+* C0 first, the others ordered by target residency
+* - Input: arg (table of states)
+* - Output: *t (parsed table)
+*           bool (false if the table is invalid)
+*******************************************************************************/
+bool parseCStates(const char *arg, CStateTable *t)
+{
+    const char *at = arg;
+
+    memset(t, 0, sizeof(*t));   // Compared bytewise by the checkpoints
+    while (*at != '\0')
+    {
+        size_t len = strcspn(at, ":");
+        char *end;
+
+        if (t->n == CSTATE_MAX || len == 0 || len >= CSTATE_NAME || at[len] != ':')
+            return false;
+        memcpy(t->name[t->n], at, len);
+        t->residency[t->n] = strtod(at + len + 1, &end);
+        if (*end != ':')
+            return false;
+        t->latency[t->n] = strtod(end + 1, &end);
+        if (*end != ':')
+            return false;
+        t->power[t->n] = strtod(end + 1, &end);
+        if ((*end != ',' && *end != '\0') || t->latency[t->n] < 0 || t->power[t->n] < 0)
+            return false;
+        if (t->n > 0 && t->residency[t->n] < t->residency[t->n - 1])
+            return false;
+        t->n++;
+        at = (*end == ',') ? end + 1 : end;
+    }
+    return t->n > 0 && t->residency[0] == 0 && t->latency[0] == 0;
+}
+
+/*******************************************************************************
+*       parseIdlePolicy(const char *arg, const CStateTable *t, int *policy,
+*                       int *fixed)
+********************************************************************************
+* Function that parses an idle policy, or the name of a state of the table
+* - Input: arg (idle policy, see the notes above)
+*           *t (table of states)
+* - Output: *policy (CPOLICY_*)
+*           *fixed (state of CPOLICY_FIXED, deepest state of the others)
+*           bool (false if arg is neither)
+*******************************************************************************/
+bool parseIdlePolicy(const char *arg, const CStateTable *t, int *policy, int *fixed)
+{
+    *fixed = t->n - 1;
+    for (int i = 0; i < CPOLICY_FIXED; i++)
+    {
+        if (strcmp(arg, cpolicyNames[i]) == 0)
+        {
+            *policy = i;
+            return true;
+        }
+    }
+    for (int i = 0; i < t->n; i++)
+    {
+        if (strcmp(arg, t->name[i]) == 0)
+        {
+            *policy = CPOLICY_FIXED;
+            *fixed = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+*       parsePkgPolicy(const char *arg, const CStateTable *t, int *policy,
+*                      int *limit)
+********************************************************************************
+* Function that parses the policy of the package: off, auto (the timer policy
+* down to the deepest state) or the name of the deepest state allowed
+* - Input: arg (package policy)
+*           *t (table of the package states)
+* - Output: *policy (CPOLICY_OFF or CPOLICY_TIMER)
+*           *limit (deepest state allowed)
+*           bool (false if arg is none of them)
+*******************************************************************************/
+bool parsePkgPolicy(const char *arg, const CStateTable *t, int *policy, int *limit)
+{
+    *policy = CPOLICY_TIMER;
+    *limit = t->n - 1;
+    if (strcmp(arg, "off") == 0)
+        *policy = CPOLICY_OFF;
+    else if (strcmp(arg, "auto") != 0)
+    {
+        for (*limit = 0; *limit < t->n && strcmp(arg, t->name[*limit]) != 0; (*limit)++)
+            ;
+        return *limit < t->n;
+    }
+    return true;
+}
+
+/*******************************************************************************
+*       cstateInit(CStates *cs, const CStateTable *t, int policy, int fixed, int c)
+********************************************************************************
+* Function that initializes the idle states of c cores, idle since time 0
+* - Input: *t (table of states, must outlive cs)
+*           policy, fixed (idle policy)
+*           c (number of cores)
+* - Output: *cs (idle states)
+*******************************************************************************/
+void cstateInit(CStates *cs, const CStateTable *t, int policy, int fixed, int c)
+{
+    cs->t = t;
+    cs->policy = policy;
+    cs->fixed = fixed;
+    cs->c = c;
+    cs->since = (double*)calloc(c, sizeof(double));
+    cs->predict = (double*)calloc(c, sizeof(double));
+    if (!cs->since || !cs->predict) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*******************************************************************************
+*       cstateFree(CStates *cs)
+********************************************************************************
+* Function that releases the idle states of the cores
+* - Input: *cs (idle states)
+*******************************************************************************/
+void cstateFree(CStates *cs)
+{
+    free(cs->since);
+    free(cs->predict);
+}
+
+/*******************************************************************************
+*       cstateStatsInit(CStateStats *cst, int c)
+*       cstateStatsMerge(CStateStats *dst, const CStateStats *src)
+*       cstateStatsFree(CStateStats *cst)
+********************************************************************************
+* Functions that reset, add up and release the outputs of the idle states
+* - Input: *cst / *src (outputs), c (number of cores)
+* - Output: *cst / *dst (outputs reset or summed)
+*******************************************************************************/
+void cstateStatsInit(CStateStats *cst, int c)
+{
+    memset(cst, 0, sizeof(*cst));
+    cst->c = c;
+    cst->saved = (double*)calloc(c, sizeof(double));
+    if (!cst->saved) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void cstateStatsMerge(CStateStats *dst, const CStateStats *src)
+{
+    for (int s = 0; s < CSTATE_MAX; s++)
+    {
+        dst->time[s] += src->time[s];
+        dst->wakes[s] += src->wakes[s];
+    }
+    dst->delayed += src->delayed;
+    dst->latency += src->latency;
+    for (int i = 0; i < dst->c; i++)
+        dst->saved[i] += src->saved[i];
+}
+
+void cstateStatsFree(CStateStats *cst)
+{
+    free(cst->saved);
+}
+
+/*******************************************************************************
+*       cstateSpend(const CStates *cs, CStateStats *cst, int core, int s,
+*                   double from, double to)
+********************************************************************************
+* Function that accounts for the time a core spent in a state
+* - Input: *cs (idle states)
+*           core, s (core and its state)
+*           from, to (interval, nothing if empty)
+* - Output: *cst (outputs)
+*******************************************************************************/
+static inline void cstateSpend(const CStates *cs, CStateStats *cst, int core, int s,
+                               double from, double to)
+{
+    if (to <= from)
+        return;
+    cst->time[s] += to - from;
+    cst->saved[core] += (cs->t->power[0] - cs->t->power[s]) * (to - from);
+}
+
+/*******************************************************************************
+*       cstateIdle(CStates *cs, CStateStats *cst, int core, double time,
+*                  double from)
+********************************************************************************
+* Function that accounts for the idle period of a core up to a time, in the
+* states the policy took it through
+* - Input: *cs (idle states)
+*           core (idle core)
+*           time (end of the idle period)
+*           from (start of the statistics, earlier time is not accounted for)
+* - Output: *cst (outputs)
+*           int (state of the core at the end of the period)
+*******************************************************************************/
+int cstateIdle(CStates *cs, CStateStats *cst, int core, double time, double from)
+{
+    const CStateTable *t = cs->t;
+    double start = cs->since[core], idle = time - start;
+    int s = 0;
+
+    switch (cs->policy) {
+        case CPOLICY_LADDER:
+        case CPOLICY_TIMER:
+            if (cs->policy == CPOLICY_LADDER && t->n > 1)
+                s = 1;          // The shallowest state at once
+            while (s < cs->fixed && idle >= t->residency[s + 1])
+            {
+                double deeper = cs->since[core] + t->residency[s + 1];
+                cstateSpend(cs, cst, core, s, fmax(from, start), deeper);
+                start = deeper;
+                s++;
+            }
+            break;
+        case CPOLICY_MENU:
+            while (s + 1 < t->n && cs->predict[core] >= t->residency[s + 1])
+                s++;
+            break;
+        case CPOLICY_ORACLE:
+            while (s + 1 < t->n && idle >= t->residency[s + 1])
+                s++;
+            break;
+        case CPOLICY_FIXED:
+            s = cs->fixed;
+            break;
+    }
+    cstateSpend(cs, cst, core, s, fmax(from, start), time);
+    return s;
+}
+
+/*******************************************************************************
+*       cstateSleep(CStates *cs, int core, double time)
+********************************************************************************
+* Function that records that a core goes idle
+* - Input: *cs (idle states)
+*           core (core going idle)
+*           time (current time)
+*******************************************************************************/
+static inline void cstateSleep(CStates *cs, int core, double time)
+{
+    cs->since[core] = time;
+}
+
+/*******************************************************************************
+*       cstateWake(CStates *cs, CStateStats *cst, int core, double time,
+*                  double from)
+********************************************************************************
+* Function that wakes an idle core for a job, accounts for its idle period and
+* returns the exit latency the job waits
+* - Input: *cs (idle states)
+*           core (idle core)
+*           time (arrival of the job)
+*           from (start of the statistics)
+* - Output: *cst (outputs)
+*           double (exit latency of the state of the core)
+*******************************************************************************/
+double cstateWake(CStates *cs, CStateStats *cst, int core, double time, double from)
+{
+    double idle = time - cs->since[core];
+
+    if (idle <= 0)
+        return 0.0;     // Never went idle
+    int s = cstateIdle(cs, cst, core, time, from);
+    cs->predict[core] += MENU_WEIGHT * (idle - cs->predict[core]);
+    cst->wakes[s]++;
+    if (cs->t->latency[s] > 0)
+    {
+        cst->delayed++;
+        cst->latency += cs->t->latency[s];
+    }
+    return cs->t->latency[s];
+}
+
+/*******************************************************************************
+*       cstatePower(const CStateTable *t, const CStateStats *cst, int core,
+*                   double time)
+********************************************************************************
+* Function that computes the average power of a core
+* - Input: *t (table of states)
+*           *cst (outputs)
+*           core (core, -1 for the average over the cores)
+*           time (length of the run)
+* - Output: double (power in W)
+*******************************************************************************/
+double cstatePower(const CStateTable *t, const CStateStats *cst, int core, double time)
+{
+    double saved = 0.0;
+
+    if (core >= 0)
+        saved = cst->saved[core];
+    else
+    {
+        for (int i = 0; i < cst->c; i++)
+            saved += cst->saved[i];
+        saved /= cst->c;
+    }
+    return t->power[0] - saved / time;
+}
+
+/*******************************************************************************
+*       printCStates(const char *title, const CStateTable *t, const char *policy,
+*                    const CStateStats *cst, double time, unsigned long jobs,
+*                    double unit)
+********************************************************************************
+* Function that prints the residency of each state and the latency the
+* wake-ups added to the jobs
+* - Input: title (what the states belong to, e.g. "CORE")
+*           *t (table of states)
+*           policy (name of the idle policy)
+*           *cst (outputs)
+*           time (length of the run)
+*           jobs (jobs served)
+*           unit (seconds per unit of time)
+*******************************************************************************/
+void printCStates(const char *title, const CStateTable *t, const char *policy,
+                  const CStateStats *cst, double time, unsigned long jobs, double unit)
+{
+    double total = time * cst->c, asleep = 0.0;
+
+    for (int s = 1; s < t->n; s++)
+        asleep += cst->time[s];
+    printf("<-------------------------------------------------------------> \n");
+    printf("-  %s IDLE STATES (policy %s): \n", title, policy);
+    for (int s = 0; s < t->n; s++)
+    {
+        double residency = (s == 0) ? total - asleep : cst->time[s];
+        printf("-    %-8s residency           = %f %% (%lu wake-ups, exit latency %g us, %g W) \n",
+               t->name[s], 100.0 * residency / total, cst->wakes[s], t->latency[s] * unit * 1e6, t->power[s]);
+    }
+    printf("-    Idle polling in %-12s = %f %% \n", t->name[0], 100.0 * cst->time[0] / total);
+    printf("-    Wake-up latency per job      = %f us (%f %% of the jobs delayed) \n",
+           cst->latency / (jobs ? jobs : 1) * unit * 1e6, 100.0 * cst->delayed / (jobs ? jobs : 1));
+}
+
+/*******************************************************************************
+*       printCStateEnergy(const CStateTable *t, const CStateStats *cst,
+*                         double time, double unit)
+********************************************************************************
+* Function that prints the energy of each core (or of the package), busy in C0
+* - Input: *t (table of states)
+*           *cst (outputs)
+*           time (length of the run)
+*           unit (seconds per unit of time)
+*******************************************************************************/
+void printCStateEnergy(const CStateTable *t, const CStateStats *cst, double time, double unit)
+{
+    if (cst->c == 1)
+    {
+        printf("-    Energy                       = %f J (%f W) \n",
+               cstatePower(t, cst, 0, time) * time * unit, cstatePower(t, cst, 0, time));
+        return;
+    }
+    printf("-    Energy per core: \n");
+    for (int i = 0; i < cst->c; i++)
+        printf("-    Core %d                    = %f J (%f W) \n", i,
+               cstatePower(t, cst, i, time) * time * unit, cstatePower(t, cst, i, time));
+    printf("-    Power of the cores           = %f W (%f W per core) \n",
+           cst->c * cstatePower(t, cst, -1, time), cstatePower(t, cst, -1, time));
+}
+
+#endif
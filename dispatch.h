@@ -0,0 +1,217 @@
+/*******************************************************************************
+*                          Load-Balancing Policies
+********************************************************************************
+* Notes: Dispatchers of a system where every server has its own queue. The
+* policy is chosen at startup (-P) and each one keeps incremental state, so a
+* dispatch costs O(1) or O(log c) instead of a scan of the c queues:
+*   random      uniform random server
+*   rr          round-robin
+*   jsq         join the shortest queue (min-heap of the queue lengths)
+*   pod         power of d choices: shortest of d random servers (O(d))
+*   lwl         least work left (min-heap of the time each server will have
+*               finished its queued work; needs the service time on arrival)
+*   idle-jsq    random idle server if any, else join the shortest queue
+* Ties are broken by the heap order, so a run only depends on its seed.
+*------------------------------------------------------------------------------*
+* Usage:
+*   Dispatch ds;
+*   dispatchInit(&ds, POLICY_JSQ, 2, c, &rng, &idleServers);
+*   server = dispatchPick(&ds);
+*   dispatchArrive(&ds, server, time, service);   // job queued on server
+*   dispatchDepart(&ds, server);                  // job left server
+*******************************************************************************/
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for malloc() and exit()
+#include <string.h>             // Needed for strcmp()
+#include <stdbool.h>            // Needed for bool type
+#include "rng.h"                // Needed for rngBelow()
+#include "heap.h"               // Needed for DepHeap
+#include "idleset.h"            // Needed for IdleSet
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define POD_CHOICES    2        // Default d of the power of d choices
+
+enum {                          // Load-balancing policies
+    POLICY_RANDOM,
+    POLICY_RR,
+    POLICY_JSQ,
+    POLICY_POD,
+    POLICY_LWL,
+    POLICY_IDLE_JSQ,
+    NUM_POLICIES
+};
+
+static const char *policyNames[NUM_POLICIES] = {
+    "random", "rr", "jsq", "pod", "lwl", "idle-jsq" };
+
+typedef struct Dispatch {       // State of a dispatcher
+    int policy;                 // POLICY_*
+    int d;                      // Choices of the power of d choices
+    int c;                      // Number of servers
+    int next;                   // Next server of the round-robin
+    Rng *rng;                   // Stream of the random choices
+    IdleSet *idle;              // Idle servers (not owned)
+    double *length;             // Jobs at each server, in service or queued
+    double *workEnd;            // Time each server will have finished its work
+    DepHeap shortest;           // Servers by queue length (jsq, idle-jsq)
+    DepHeap least;              // Servers by end of work (lwl)
+    bool needSize;              // Service times must be drawn on arrival
+} Dispatch;
+
+/*******************************************************************************
+*       parsePolicy(const char *arg, int *policy)
+********************************************************************************
+* Function that parses the name of a policy
+* - Input: arg (name of the policy, see the notes above)
+* - Output: *policy (POLICY_*)
+*           bool (false if the name is unknown)
+*******************************************************************************/
+bool parsePolicy(const char *arg, int *policy)
+{
+    for (int i = 0; i < NUM_POLICIES; i++)
+    {
+        if (strcmp(arg, policyNames[i]) == 0)
+        {
+            *policy = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+*       dispatchInit(Dispatch *ds, int policy, int d, int c, Rng *rng,
+*                    IdleSet *idle)
+********************************************************************************
+* Function that initializes a dispatcher over c empty servers
+* - Input: *ds (dispatcher to initialize)
+*           policy (POLICY_*)
+*           d (choices of the power of d choices)
+*           c (number of servers)
+*           *rng (stream of the random choices)
+*           *idle (idle servers, kept up to date by the caller)
+*******************************************************************************/
+void dispatchInit(Dispatch *ds, int policy, int d, int c, Rng *rng, IdleSet *idle)
+{
+    ds->policy = policy;
+    ds->d = d;
+    ds->c = c;
+    ds->next = c - 1;
+    ds->rng = rng;
+    ds->idle = idle;
+    ds->length = (double*)calloc(c, sizeof(double));
+    ds->workEnd = (double*)calloc(c, sizeof(double));
+    if (!ds->length || !ds->workEnd) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    heapInit(&ds->shortest, ds->length, c);
+    heapInit(&ds->least, ds->workEnd, c);
+    ds->needSize = (policy == POLICY_LWL);
+}
+
+/*******************************************************************************
+*       dispatchPick(Dispatch *ds)
+********************************************************************************
+* Function that chooses the server of an arriving job
+* - Input: *ds (dispatcher)
+* - Output: int (index of the server)
+*******************************************************************************/
+int dispatchPick(Dispatch *ds)
+{
+    int best;
+
+    switch (ds->policy) {
+        case POLICY_RR:
+            ds->next = (ds->next + 1 == ds->c) ? 0 : ds->next + 1;
+            return ds->next;
+        case POLICY_JSQ:
+            return heapMin(&ds->shortest);
+        case POLICY_POD:
+            best = rngBelow(ds->rng, ds->c);
+            for (int i = 1; i < ds->d; i++)
+            {
+                int other = rngBelow(ds->rng, ds->c);
+                if (ds->length[other] < ds->length[best])
+                    best = other;
+            }
+            return best;
+        case POLICY_LWL:
+            return heapMin(&ds->least);
+        case POLICY_IDLE_JSQ:
+            if (ds->idle->count > 0)
+                return idleAt(ds->idle, rngBelow(ds->rng, ds->idle->count));
+            return heapMin(&ds->shortest);
+        default:    // POLICY_RANDOM
+            return rngBelow(ds->rng, ds->c);
+    }
+}
+
+/*******************************************************************************
+*       dispatchArrive(Dispatch *ds, int server, double time, double service)
+*       dispatchDepart(Dispatch *ds, int server)
+********************************************************************************
+* Functions that update the dispatcher when a job joins a server and when a
+* job leaves it
+* - Input: *ds (dispatcher)
+*           server (index of the server)
+*           time (arrival time of the job)
+*           service (service time of the job, only used if needSize)
+*******************************************************************************/
+void dispatchArrive(Dispatch *ds, int server, double time, double service)
+{
+    if (ds->policy == POLICY_POD)
+        ds->length[server] += 1;
+    else if (ds->policy == POLICY_JSQ || ds->policy == POLICY_IDLE_JSQ)
+        heapUpdate(&ds->shortest, server, ds->length[server] + 1);
+    else if (ds->policy == POLICY_LWL)
+    {
+        double start = (ds->workEnd[server] > time) ? ds->workEnd[server] : time;
+        heapUpdate(&ds->least, server, start + service);
+    }
+}
+
+void dispatchDepart(Dispatch *ds, int server)
+{
+    if (ds->policy == POLICY_POD)
+        ds->length[server] -= 1;
+    else if (ds->policy == POLICY_JSQ || ds->policy == POLICY_IDLE_JSQ)
+        heapUpdate(&ds->shortest, server, ds->length[server] - 1);
+}
+
+/*******************************************************************************
+*       dispatchStretch(Dispatch *ds, int server, double extra)
+********************************************************************************
+* Function that adds to the work left of a server the time its job in service
+* takes beyond its service time (lower frequency, wake-up latency), so the
+* least-work-left policy follows the actual departure of the job
+* - Input: *ds (dispatcher)
+*           server (index of the server starting the job)
+*           extra (actual duration of the job minus its service time)
+*******************************************************************************/
+void dispatchStretch(Dispatch *ds, int server, double extra)
+{
+    if (ds->policy == POLICY_LWL)
+        heapUpdate(&ds->least, server, ds->workEnd[server] + extra);
+}
+
+/*******************************************************************************
+*       dispatchFree(Dispatch *ds)
+********************************************************************************
+* Function that releases the memory of a dispatcher
+* - Input: *ds (dispatcher to release)
+*******************************************************************************/
+void dispatchFree(Dispatch *ds)
+{
+    heapFree(&ds->shortest);
+    heapFree(&ds->least);
+    free(ds->length);
+    free(ds->workEnd);
+}
+
+#endif
@@ -0,0 +1,2404 @@
+/*******************************************************************************
+*                          Queueing Simulation Engine
+********************************************************************************
+* Notes: Event loop, statistics, replications and sweeps shared by every
+* simulator (M/M/1, M/M/1/k, M/M/c-1, M/M/c-2). A simulator is a thin file
+* that sets the MODEL_* macros below, includes this header and prints its own
+* report. The MODEL_* macros are compile-time constants, so the compiler drops
+* the branches of the event loop a model does not use.
+*
+* The engine has no time unit of its own: times are in the unit of the model
+* (seconds for M/M/1, us for M/M/c), and TIME_UNIT (seconds per unit) is only
+* used to report rates and sojourn times in seconds.
+*------------------------------------------------------------------------------*
+* Model parameters (define before including, defaults in brackets):
+*   MODEL_QUEUE     QUEUE_SHARED: one queue, jobs go to a random idle server
+*                   QUEUE_PER_SERVER: jobs go to the server chosen by the
+*                   load-balancing policy (-P) and wait in its own queue
+*                   [QUEUE_SHARED]
+*   MODEL_CAPACITY  1 to drop the arrivals that find k customers [0]
+*   MODEL_SERVERS   number of servers fixed at compile time, 0 to take it
+*                   from -c; with 1 the event loop drops the departure heap,
+*                   the idle set and the dispatch of the servers [0]
+*   MODEL_STATS     STAT_* flags of the distributions to collect [0]
+*   MODEL_POWER     1 to model the power of the cores and of the package
+*                   (idle states, -L and -K, and frequencies, -F) [0]
+*   TIME_UNIT       seconds per unit of time [1.0]
+*   MODEL_NAME      name written in the model field of the results ["queue"]
+*   SIM_TIME, ARR_TIME, SERV_TIME, NUM_SERVERS, CAPACITY, CORE_EDGES,
+*   PKG_EDGES, CSTATES, PKG_CSTATES, PSTATES, PSTATE_WINDOW  defaults of
+*                   the command line options
+*------------------------------------------------------------------------------*
+* Usage:
+*   #define MODEL_QUEUE     QUEUE_PER_SERVER
+*   #define MODEL_STATS     (STAT_CORE_IDLE | STAT_PKG_IDLE)
+*   #include "engine.h"
+*   void printReport(const Params *p, Stats *st) { ... }
+*   int main(int argc, char **argv)
+*   {
+*       Config cfg;
+*       configInit(&cfg);
+*       if (!parseOptions(argc, argv, "a:d:s:c:S:R:j:o:", &cfg))
+*           show_usage(argv[0]);
+*       runModel(&cfg, printReport);
+*   }
+*******************************************************************************/
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for malloc(), exit() and strtoull()
+#include <unistd.h>             // Needed for getopt()
+#include <getopt.h>             // Needed for getopt_long()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for INFINITY
+#include "alloc.h"              // Needed to count the allocations (first)
+#include "utils.h"              // Needed for expntl()
+#include "sampler.h"            // Needed for Sampler and sampleNext()
+#include "arrival.h"            // Needed for Arrivals and arrivalNext()
+#include "samples.h"            // Needed for SampleBuf
+#include "histogram.h"          // Needed for Histogram and EdgeDistr
+#include "fifo.h"               // Needed for Fifo
+#include "heap.h"               // Needed for DepHeap
+#include "idleset.h"            // Needed for IdleSet
+#include "dispatch.h"           // Needed for Dispatch
+#include "warmup.h"             // Needed for Series and mserTruncation()
+#include "replicate.h"          // Needed for runReplications()
+#include "sweep.h"              // Needed for parseAxis() and runSweep()
+#include "output.h"             // Needed for Record and outputWrite()
+#include "trace.h"              // Needed for Trace and traceAdd()
+#include "replay.h"             // Needed for Replay and replayNext()
+#include "checkpoint.h"         // Needed for Ckpt
+#include "bench.h"              // Needed for benchMeasure()
+#include "probe.h"              // Needed for probeCount() and probeTime()
+#include "analytic.h"           // Needed for Theory and theoryMMc()
+#include "cstate.h"             // Needed for CStates and cstateWake()
+#include "pstate.h"             // Needed for PStates and pstateJob()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define QUEUE_SHARED       0    // One queue, dispatch to a random idle server
+#define QUEUE_PER_SERVER   1    // Dispatch by policy, one queue per server
+
+#define STAT_CORE_IDLE     0x1  // Idle periods of every core
+#define STAT_PKG_IDLE      0x2  // Package idle periods (every core idle)
+#define STAT_FULL_BUSY     0x4  // Full busy periods (every core busy)
+#define STAT_PER_CORE      0x8  // Core idle distribution of each core
+
+#define OPT_RESUME         256  // Code of --resume (long options only)
+#define OPT_BENCH          257  // Code of --bench
+#define OPT_BASELINE       258  // Code of --baseline
+#define OPT_ANALYTIC       259  // Code of --analytic
+#define OPT_VALIDATE       260  // Code of --validate
+
+#define VALIDATE_TOLERANCE 0.05 // Deviation from theory reported by --validate
+
+#ifndef MODEL_QUEUE
+#define MODEL_QUEUE        QUEUE_SHARED
+#endif
+#ifndef MODEL_CAPACITY
+#define MODEL_CAPACITY     0
+#endif
+#ifndef MODEL_SERVERS
+#define MODEL_SERVERS      0
+#endif
+#ifndef MODEL_STATS
+#define MODEL_STATS        0
+#endif
+#ifndef MODEL_POWER
+#define MODEL_POWER        0
+#endif
+#ifndef TIME_UNIT
+#define TIME_UNIT          1.0
+#endif
+#ifndef MODEL_NAME
+#define MODEL_NAME         "queue"
+#endif
+#ifndef NUM_SERVERS
+#define NUM_SERVERS        1
+#endif
+#ifndef CAPACITY
+#define CAPACITY           10
+#endif
+#ifndef CORE_EDGES
+#define CORE_EDGES         "2,20,600"
+#endif
+#ifndef PKG_EDGES
+#define PKG_EDGES          "10,100,1000"
+#endif
+#ifndef CSTATES
+#define CSTATES            "C0:0:0:4,C1:2:2:1.44,C1E:20:10:1,C6:600:133:0.1"
+#endif
+#ifndef PKG_CSTATES
+#define PKG_CSTATES        "PC0:0:0:20,PC2:10:20:12,PC6:1000:300:4"
+#endif
+#ifndef PSTATES
+#define PSTATES            "1.0:1.1,1.5:1.8,2.0:2.7,2.5:4"
+#endif
+#ifndef PSTATE_WINDOW
+#define PSTATE_WINDOW      10000
+#endif
+
+typedef struct Params {         // Inputs of a simulation run
+    double endTime;             // Total time to do Simulation
+    double arrTime;             // Mean time between arrivals
+    ArrivalSpec arrivals;       // Process of the arrivals
+    double departTime;          // Mean service time
+    Distr service;              // Distribution of the service times
+    int c;                      // Number of servers in the system
+    int k;                      // Capacity of the system (MODEL_CAPACITY)
+    int policy;                 // Load-balancing policy (QUEUE_PER_SERVER)
+    int d;                      // Choices of the power of d choices policy
+    bool warmup;                // Delete the warm-up found by MSER-5
+    double precision;           // Stop at this relative half width (0: at endTime)
+    unsigned long long seed;    // Master seed of the random streams
+    Edges coreEdges;            // Edges of the core idle time distribution
+    Edges pkgEdges;             // Edges of the package idle time distribution
+    CStateTable cstates;        // Idle states of a core (MODEL_POWER)
+    int idlePolicy;             // Idle policy of the cores (CPOLICY_*)
+    int idleState;              // State of the fixed idle policy
+    CStateTable pkgCStates;     // Idle states of the package (MODEL_POWER)
+    int pkgPolicy;              // Policy of the package (CPOLICY_OFF or _TIMER)
+    int pkgLimit;               // Deepest state of the package allowed
+    PStateTable pstates;        // Frequencies of a core (MODEL_POWER)
+    Governor governor;          // Governor of the frequencies
+    const char *traceFile;      // Event trace of replication 0 (NULL if none)
+    const char *replayFile;     // Log of jobs replayed (NULL: exponential)
+    double replayScale;         // Arrival speed-up of the replayed log
+    const char *ckptFile;       // Checkpoint of the run (NULL if none)
+    double ckptInterval;        // Seconds of wall-clock time between checkpoints
+    bool resume;                // Start from the checkpoint instead of time 0
+} Params;
+
+typedef struct Stats {          // Outputs of one replication (or of several merged)
+    int c;                      // Number of servers (length of the per-core arrays)
+    bool warmup;                // Warm-up deletion was requested
+    double warmupTime;          // Simulated time deleted as warm-up
+    double time;                // Simulated time (after the warm-up)
+    unsigned long arrived;      // Customers that arrived
+    unsigned long dropped;      // Customers dropped because the system was full
+    unsigned long waited;       // Customers that waited in a queue
+    unsigned long departures;   // Total number of customers served
+    double busyTime;            // Time with every server busy
+    double s;                   // Area of number of customers in system
+    double busyTimeAll;         // Added by Georgia sum all busy periods (not only full busy)
+    double idleTimeAll;         // Added by Georgia sum all idle periods (not only full idle)
+    double *arrivals;           // added by georgia number of customers served per core
+    Histogram coreidlePeriods;  // Added by Georgia histogram of core idle period duration
+    Histogram packageIdlePeriods; // Added by Georgia histogram of package idle period duration
+    Histogram fullBusyPeriods;  // Added by Georgia histogram of full busy period duration
+    Histogram waitTimes;        // Time each customer waited in a queue
+    Histogram responseTimes;    // Time each customer spent in the system
+    Estimate responseMean;      // Batch means estimate of the mean response time
+    EdgeDistr coreIdleDistr;    // Core idle time below each edge
+    EdgeDistr pkgIdleDistr;     // Package idle time below each edge
+    EdgeDistr *coreIdleDistrPerCore; // Core idle time below each edge, per core
+    Arena arena;                // Memory of the raw samples (KEEP_SAMPLES)
+    SampleBuf arrivalPeriods;   // Added by Georgia interarrival times
+    SampleBuf servicePeriods;   // Added by Georgia service times
+    SampleBuf *arrivalsPerCore; // added by georgia arrival times seen by each core
+    CStateStats cstates;        // Idle states of the cores (MODEL_POWER)
+    CStateStats pkgCStates;     // Idle states of the package (MODEL_POWER)
+    PStateStats pstates;        // Frequencies of the cores (MODEL_POWER)
+    Probes probes;              // Hot-path counters (PROBES)
+} Stats;
+
+#define WARMUP_SEGMENTS    (SERIES_MAX / SERIES_SEGMENT)
+
+typedef struct Segments {       // Outputs of a warm-up, cut where it may end
+    int n;                      // Closed segments, oldest first
+    double start[WARMUP_SEGMENTS];  // Start of each segment
+    Stats st[WARMUP_SEGMENTS];  // Outputs of each segment
+} Segments;
+
+typedef struct SimState {       // State of a run, as saved in its checkpoint
+    double time;                // Current Simulation time
+    double nextArrival;         // Time for next arrival
+    double nextService;         // Service time of the next arrival (replay)
+    double lastEventTime;       // Time of the last event
+    double lastBusyTime;        // Start of the full busy period, -1 if none
+    double pkgIdleStart;        // Start of the package idle period, -1 if none
+    double warmupEnd;           // End of the deleted warm-up
+    double statsFrom;           // Start of the outputs of st
+    bool steady;                // Warm-up over (or not looked for)
+    unsigned long n;            // Customers in the system
+    Rng *streams;               // Random streams (NUM_STREAMS)
+    Arrivals *arrivals;         // Process of the arrivals
+    Sampler *servStream;        // Block of service times
+    double *departure;          // Departure time per server
+    double *idleStart;          // Start of idle period per core
+    double *jobArrival;         // Arrival time of the customer in service
+    Fifo *jobsQueue;            // Arrival time of the queued jobs, per queue
+    Fifo *sizeQueue;            // Service time of the queued jobs, per queue
+    int queues;                 // Number of queues
+    DepHeap *depHeap;           // Servers ordered by departure time
+    IdleSet *idleServers;       // Servers not serving any customer
+    CStates *cstates;           // Idle states of the cores (MODEL_POWER)
+    CStates *pkgCStates;        // Idle states of the package (MODEL_POWER)
+    PStates *pstates;           // Frequencies of the cores (MODEL_POWER)
+    Dispatch *dispatch;         // Load-balancing policy
+    Series *series;             // Batch means of the response time
+    Segments *segments;         // Outputs of the warm-up (NULL without -w)
+    Replay *replay;             // Log of jobs replayed (NULL if none)
+    Stats *st;                  // Outputs accumulated so far
+} SimState;
+
+typedef void (*ReportFunc)(const Params *p, Stats *st);
+
+typedef struct Config {         // Command line of a simulator
+    Params p;                   // Inputs (first value of every axis)
+    Axis arr;                   // Values of -a
+    Axis dep;                   // Values of -d
+    Axis servers;               // Values of -c
+    Axis cap;                   // Values of -k
+    int reps;                   // Replications of each point
+    int threads;                // Threads running the replications
+    int format;                 // Format of the results (FORMAT_*)
+    char *outFile;              // File the records are written to (stdout if NULL)
+    const char *optstring;      // Options accepted by the simulator
+    unsigned long bench;        // Events per point of the benchmark (0: no benchmark)
+    const char *baseline;       // Benchmark compared with (NULL if none)
+    bool analytic;              // Closed forms instead of simulations
+    bool validate;              // Compare the simulations with the closed forms
+} Config;
+
+typedef struct Run {            // Context shared by the replications of a point
+    const Params *p;
+    Stats *stats;               // Outputs of each replication
+} Run;
+
+typedef struct Grid {           // Context shared by the points of a sweep
+    Params *params;             // Inputs of each point
+    Stats **stats;              // Outputs of the replications of each point
+    Record **records;           // Record of each point done, until written
+    int reps;                   // Replications of each point
+    Output *out;                // Destination of the records
+    bool validate;              // Compare every point with its closed form
+    int deviations;             // Outputs that deviate from their closed form
+} Grid;
+
+enum {                          // Outputs estimated over the replications
+    EST_THROUGHPUT,
+    EST_UTILIZATION,
+    EST_CUSTOMERS,
+    EST_SOJOURN,
+    EST_AVG_UTILIZATION,
+    EST_BLOCKING,
+    EST_WAITING,                // Customers that wait in a queue
+    EST_RESPONSE_P50,           // Percentiles of the response time
+    EST_RESPONSE_P99,
+    EST_RESPONSE_P999,
+    EST_WARMUP,                 // Simulated time deleted as warm-up
+    EST_RUN_LENGTH,             // Simulated time kept
+    EST_IDLE                    // First fraction of the core idle distribution
+};
+
+static const char *estNames[EST_IDLE] = {   // Fields of the outputs in the records
+    "throughput", "utilization", "customers", "sojourn", "avg_utilization",
+    "blocking", "waiting", "response_p50", "response_p99", "response_p999", "warmup",
+    "run_length" };
+static const char *estLabels[EST_IDLE] = {  // Names of the outputs in the reports
+    "Throughput rate", "Server utilization", "Avg # of cust. in system",
+    "Mean Sojourn time", "Average utilization", "Blocking probability",
+    "Waiting probability", "Response time p50", "Response time p99",
+    "Response time p99.9", "Warm-up deleted", "Simulated time kept" };
+static const char *estUnits[EST_IDLE] = {
+    "cust/sec", "%", "cust", "sec", "%", "%", "%", "sec", "sec", "sec", "sec", "sec" };
+
+/*******************************************************************************
+*       statsInit(Stats *st, const Params *p)
+********************************************************************************
+* Function that resets the outputs of a replication
+* - Input: *st (outputs to reset)
+*           *p (inputs of the simulation)
+*******************************************************************************/
+void statsInit(Stats *st, const Params *p)
+{
+    int c = p->c;
+
+    st->c = c;
+    st->warmup = p->warmup;
+    st->warmupTime = 0.0;
+    st->time = 0.0;
+    st->arrived = 0;
+    st->dropped = 0;
+    st->waited = 0;
+    st->departures = 0;
+    st->busyTime = 0.0;
+    st->s = 0.0;
+    st->busyTimeAll = 0.0;
+    st->idleTimeAll = 0.0;
+    st->probes = (Probes){0};
+    st->pstates = (PStateStats){0};
+    st->arrivals = (double*)calloc(c, sizeof(double));
+    st->coreIdleDistrPerCore = NULL;
+    st->arrivalsPerCore = NULL;
+    if (!st->arrivals) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    histInit(&st->coreidlePeriods);
+    histInit(&st->packageIdlePeriods);
+    histInit(&st->fullBusyPeriods);
+    histInit(&st->waitTimes);
+    histInit(&st->responseTimes);
+    estInit(&st->responseMean);
+    edgeInit(&st->coreIdleDistr, &p->coreEdges);
+    edgeInit(&st->pkgIdleDistr, &p->pkgEdges);
+    if (MODEL_POWER)
+    {
+        cstateStatsInit(&st->cstates, c);
+        cstateStatsInit(&st->pkgCStates, 1);
+    }
+    if (MODEL_STATS & STAT_PER_CORE)
+    {
+        st->coreIdleDistrPerCore = (EdgeDistr*)malloc(c * sizeof(EdgeDistr));
+        if (!st->coreIdleDistrPerCore) {
+            printf("Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < c; i++)
+            edgeInit(&st->coreIdleDistrPerCore[i], &p->coreEdges);
+    }
+
+    st->arena = (Arena){0};
+    sampleInit(&st->arrivalPeriods, &st->arena);
+    sampleInit(&st->servicePeriods, &st->arena);
+    if (KEEP_SAMPLES)
+    {
+        st->arrivalsPerCore = (SampleBuf*)malloc(c * sizeof(SampleBuf));
+        if (!st->arrivalsPerCore) {
+            printf("Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < c; i++)
+            sampleInit(&st->arrivalsPerCore[i], &st->arena);
+    }
+}
+
+/*******************************************************************************
+*       statsMerge(Stats *dst, Stats *src)
+********************************************************************************
+* Function that adds the outputs of one replication to another: times, counts
+* and distributions are summed, so the ratios of the report are pooled over
+* the replications. Raw samples (KEEP_SAMPLES) are not merged.
+* - Input: *dst (outputs to add to)
+*           *src (outputs of one replication)
+*******************************************************************************/
+void statsMerge(Stats *dst, Stats *src)
+{
+    dst->warmupTime += src->warmupTime;
+    dst->time += src->time;
+    dst->arrived += src->arrived;
+    dst->dropped += src->dropped;
+    dst->waited += src->waited;
+    dst->departures += src->departures;
+    dst->busyTime += src->busyTime;
+    dst->s += src->s;
+    dst->busyTimeAll += src->busyTimeAll;
+    dst->idleTimeAll += src->idleTimeAll;
+    for (int i = 0; i < dst->c; i++)
+        dst->arrivals[i] += src->arrivals[i];
+    histMerge(&dst->coreidlePeriods, &src->coreidlePeriods);
+    histMerge(&dst->packageIdlePeriods, &src->packageIdlePeriods);
+    histMerge(&dst->fullBusyPeriods, &src->fullBusyPeriods);
+    histMerge(&dst->waitTimes, &src->waitTimes);
+    histMerge(&dst->responseTimes, &src->responseTimes);
+    edgeMerge(&dst->coreIdleDistr, &src->coreIdleDistr);
+    edgeMerge(&dst->pkgIdleDistr, &src->pkgIdleDistr);
+    if (MODEL_STATS & STAT_PER_CORE)
+        for (int i = 0; i < dst->c; i++)
+            edgeMerge(&dst->coreIdleDistrPerCore[i], &src->coreIdleDistrPerCore[i]);
+    if (MODEL_POWER)
+    {
+        cstateStatsMerge(&dst->cstates, &src->cstates);
+        cstateStatsMerge(&dst->pkgCStates, &src->pkgCStates);
+        pstateStatsMerge(&dst->pstates, &src->pstates);
+    }
+    probeMerge(&dst->probes, &src->probes);
+}
+
+/*******************************************************************************
+*       statsFree(Stats *st)
+********************************************************************************
+* Function that releases the per-core outputs and the samples of a replication
+* - Input: *st (outputs to release)
+*******************************************************************************/
+void statsFree(Stats *st)
+{
+    free(st->arrivals);
+    free(st->coreIdleDistrPerCore);
+    free(st->arrivalsPerCore);
+    if (MODEL_POWER)
+    {
+        cstateStatsFree(&st->cstates);
+        cstateStatsFree(&st->pkgCStates);
+    }
+    arenaFree(&st->arena);
+}
+
+/*******************************************************************************
+*       statsMove(Stats *dst, Stats *src)
+********************************************************************************
+* Function that moves the outputs of a replication to another place (the
+* sample buffers follow their arena)
+* - Input: *src (outputs to move, no longer valid after the move)
+* - Output: *dst (moved outputs)
+*******************************************************************************/
+void statsMove(Stats *dst, Stats *src)
+{
+    *dst = *src;
+    dst->arrivalPeriods.arena = &dst->arena;
+    dst->servicePeriods.arena = &dst->arena;
+    if (KEEP_SAMPLES)
+        for (int i = 0; i < dst->c; i++)
+            dst->arrivalsPerCore[i].arena = &dst->arena;
+}
+
+/*******************************************************************************
+*       statsAppend(Stats *dst, Stats *src)
+********************************************************************************
+* Function that adds the outputs of the next part of a run to those of the
+* previous parts (statsMerge(), raw samples included) and releases them
+* - Input: *dst (outputs of the previous parts)
+*           *src (outputs of the next part, released)
+*******************************************************************************/
+void statsAppend(Stats *dst, Stats *src)
+{
+    statsMerge(dst, src);
+    if (KEEP_SAMPLES)
+    {
+        forEachSample(&src->arrivalPeriods, chunk, i)
+            sampleAdd(&dst->arrivalPeriods, chunk->values[i]);
+        forEachSample(&src->servicePeriods, chunk, i)
+            sampleAdd(&dst->servicePeriods, chunk->values[i]);
+        for (int s = 0; s < dst->c; s++)
+            forEachSample(&src->arrivalsPerCore[s], chunk, i)
+                sampleAdd(&dst->arrivalsPerCore[s], chunk->values[i]);
+    }
+    statsFree(src);
+}
+
+/*******************************************************************************
+*       segmentsRestart(Segments *sg, int k, Stats *st, double from)
+********************************************************************************
+* Function that ends a warm-up at the start of segment k: the outputs of the
+* segments before it are deleted, and those from it on, followed by the open
+* segment st (started at from), become the outputs of the run
+* - Input: *sg (closed segments, emptied)
+*           k (first segment kept, sg->n to keep only st)
+*           *st (outputs of the open segment)
+*           from (start of the open segment)
+* - Output: *st (outputs kept)
+*           double (end of the warm-up)
+*******************************************************************************/
+double segmentsRestart(Segments *sg, int k, Stats *st, double from)
+{
+    double end = (k < sg->n) ? sg->start[k] : from;
+
+    for (int j = 0; j < k; j++)
+        statsFree(&sg->st[j]);
+    if (k < sg->n)
+    {
+        for (int j = k + 1; j < sg->n; j++)
+            statsAppend(&sg->st[k], &sg->st[j]);
+        statsAppend(&sg->st[k], st);
+        statsMove(st, &sg->st[k]);
+    }
+    sg->n = 0;
+    return end;
+}
+
+/*******************************************************************************
+*       statsCkpt(Ckpt *ck, Stats *st)
+********************************************************************************
+* Function that saves or restores the outputs of a replication in progress
+* (raw samples, only kept with KEEP_SAMPLES, are not saved)
+* - Input: *ck (checkpoint)
+*           *st (initialized outputs to save or restore)
+*******************************************************************************/
+void statsCkpt(Ckpt *ck, Stats *st)
+{
+    ckptValue(ck, st->arrived);
+    ckptValue(ck, st->dropped);
+    ckptValue(ck, st->waited);
+    ckptValue(ck, st->departures);
+    ckptValue(ck, st->busyTime);
+    ckptValue(ck, st->s);
+    ckptValue(ck, st->busyTimeAll);
+    ckptValue(ck, st->idleTimeAll);
+    ckptBytes(ck, st->arrivals, st->c * sizeof(double));
+    ckptHistogram(ck, &st->coreidlePeriods);
+    ckptHistogram(ck, &st->packageIdlePeriods);
+    ckptHistogram(ck, &st->fullBusyPeriods);
+    ckptHistogram(ck, &st->waitTimes);
+    ckptHistogram(ck, &st->responseTimes);
+    ckptEdgeDistr(ck, &st->coreIdleDistr);
+    ckptEdgeDistr(ck, &st->pkgIdleDistr);
+    if (MODEL_STATS & STAT_PER_CORE)
+        for (int i = 0; i < st->c; i++)
+            ckptEdgeDistr(ck, &st->coreIdleDistrPerCore[i]);
+    if (MODEL_POWER)
+    {
+        ckptCStateStats(ck, &st->cstates);
+        ckptCStateStats(ck, &st->pkgCStates);
+        ckptValue(ck, st->pstates);
+    }
+}
+
+/*******************************************************************************
+*       simCkpt(const Params *p, int rep, SimState *s, bool saving)
+********************************************************************************
+* Function that saves the state of a run to its checkpoint, or restores it.
+* The inputs that shape the state must match those of the saved run; -s, -e
+* and the checkpoint options may change (e.g. to extend a finished run).
+* Replication r > 0 uses the file <checkpoint>.r.
+* - Input: *p (inputs of the run)
+*           rep (index of the replication)
+*           *s (state of the run, initialized for p)
+*           saving (true to save, false to restore)
+*******************************************************************************/
+void simCkpt(const Params *p, int rep, SimState *s, bool saving)
+{
+    struct {                    // Inputs the state depends on
+        char model[16];
+        int queue, capacity, stats, c, k, policy, d, rep, idlePolicy, idleState, pkgPolicy, pkgLimit;
+        bool warmup, replay;
+        unsigned long long seed;
+        double arrTime, departTime, replayScale;
+        Distr service;
+        ArrivalSpec arrivals;
+        Edges coreEdges, pkgEdges;
+        CStateTable cstates, pkgCStates;
+        PStateTable pstates;
+        Governor governor;
+    } key;
+    char path[CKPT_PATH];
+    Ckpt ck;
+
+    memset(&key, 0, sizeof(key));
+    snprintf(key.model, sizeof(key.model), "%s", MODEL_NAME);
+    key.queue = MODEL_QUEUE;
+    key.capacity = MODEL_CAPACITY;
+    key.stats = MODEL_STATS;
+    key.c = p->c;
+    key.k = p->k;
+    key.policy = p->policy;
+    key.d = p->d;
+    key.rep = rep;
+    key.warmup = p->warmup;
+    key.replay = (p->replayFile != NULL);
+    key.seed = p->seed;
+    key.arrTime = p->arrTime;
+    key.departTime = p->departTime;
+    key.service = p->service;
+    key.arrivals = p->arrivals;
+    key.replayScale = p->replayScale;
+    key.coreEdges = p->coreEdges;
+    key.pkgEdges = p->pkgEdges;
+    key.idlePolicy = p->idlePolicy;
+    key.idleState = p->idleState;
+    key.cstates = p->cstates;
+    key.pkgPolicy = p->pkgPolicy;
+    key.pkgLimit = p->pkgLimit;
+    key.pkgCStates = p->pkgCStates;
+    key.pstates = p->pstates;
+    key.governor = p->governor;
+
+    if (rep == 0)
+        snprintf(path, sizeof(path), "%s", p->ckptFile);
+    else
+        snprintf(path, sizeof(path), "%s.%d", p->ckptFile, rep);
+    ckptOpen(&ck, path, saving);
+    if (!ckptCheck(&ck, &key, sizeof(key))) {
+        printf("%s was saved by a run with other options!\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    ckptValue(&ck, s->time);
+    ckptValue(&ck, s->nextArrival);
+    ckptValue(&ck, s->nextService);
+    ckptValue(&ck, s->lastEventTime);
+    ckptValue(&ck, s->lastBusyTime);
+    ckptValue(&ck, s->pkgIdleStart);
+    ckptValue(&ck, s->warmupEnd);
+    ckptValue(&ck, s->statsFrom);
+    ckptValue(&ck, s->steady);
+    ckptValue(&ck, s->n);
+    ckptBytes(&ck, s->streams, NUM_STREAMS * sizeof(Rng));
+    ckptArrivals(&ck, s->arrivals);
+    ckptSampler(&ck, s->servStream);
+    ckptBytes(&ck, s->departure, p->c * sizeof(double));
+    ckptBytes(&ck, s->idleStart, p->c * sizeof(double));
+    ckptBytes(&ck, s->jobArrival, p->c * sizeof(double));
+    for (int i = 0; i < s->queues; i++)
+    {
+        ckptFifo(&ck, &s->jobsQueue[i]);
+        ckptFifo(&ck, &s->sizeQueue[i]);
+    }
+    ckptHeap(&ck, s->depHeap);
+    ckptIdle(&ck, s->idleServers);
+    if (MODEL_POWER)
+    {
+        ckptCStates(&ck, s->cstates);
+        ckptCStates(&ck, s->pkgCStates);
+        ckptPStates(&ck, s->pstates);
+    }
+    ckptDispatch(&ck, s->dispatch);
+    ckptSeries(&ck, s->series);
+    if (s->replay)
+        ckptReplay(&ck, s->replay);
+    statsCkpt(&ck, s->st);
+    if (s->segments)
+    {
+        ckptValue(&ck, s->segments->n);
+        ckptBytes(&ck, s->segments->start, sizeof(s->segments->start));
+        for (int j = 0; j < s->segments->n; j++)
+        {
+            if (!saving)
+                statsInit(&s->segments->st[j], p);
+            statsCkpt(&ck, &s->segments->st[j]);
+        }
+    }
+    ckptClose(&ck);
+}
+
+/*******************************************************************************
+*       simSave(const Params *p, int rep, SimState *s, double time,
+*               double nextArrival, double nextService, double lastEventTime,
+*               double lastBusyTime, double pkgIdleStart, double warmupEnd,
+*               double statsFrom, bool steady, unsigned long n)
+********************************************************************************
+* Function that saves the checkpoint of a run. The clock is passed by value,
+* so the event loop keeps it in registers.
+* - Input: *p (inputs of the run)
+*           rep (index of the replication)
+*           *s (state of the run)
+*           time ... n (clock of the run, see SimState)
+*******************************************************************************/
+void simSave(const Params *p, int rep, SimState *s, double time, double nextArrival,
+             double nextService, double lastEventTime, double lastBusyTime,
+             double pkgIdleStart, double warmupEnd, double statsFrom, bool steady,
+             unsigned long n)
+{
+    s->time = time;
+    s->nextArrival = nextArrival;
+    s->nextService = nextService;
+    s->lastEventTime = lastEventTime;
+    s->lastBusyTime = lastBusyTime;
+    s->pkgIdleStart = pkgIdleStart;
+    s->warmupEnd = warmupEnd;
+    s->statsFrom = statsFrom;
+    s->steady = steady;
+    s->n = n;
+    simCkpt(p, rep, s, true);
+}
+
+/*******************************************************************************
+*       nextDeparture(DepHeap *h)
+*       setDeparture(DepHeap *h, int server, double time)
+*       markBusy(IdleSet *set, int server)
+*       markIdle(IdleSet *set, int server)
+********************************************************************************
+* Functions that keep the departures and the idle servers of the event loop.
+* With MODEL_SERVERS 1 the only server needs neither the heap nor the set:
+* its departure is the key of the heap itself, and only the count of the set
+* (0 or 1) is kept.
+* - Input: *h (departure heap) / *set (idle servers)
+*           server (server to update)
+*           time (departure time of the server, INFINITY if idle)
+* - Output: int (server departing first)
+*******************************************************************************/
+static inline int nextDeparture(DepHeap *h)
+{
+    return (MODEL_SERVERS == 1) ? 0 : heapMin(h);
+}
+
+static inline void setDeparture(DepHeap *h, int server, double time)
+{
+    if (MODEL_SERVERS == 1)
+        h->key[0] = time;
+    else
+        heapUpdate(h, server, time);
+}
+
+static inline void markBusy(IdleSet *set, int server)
+{
+    if (MODEL_SERVERS == 1)
+        set->count = 0;
+    else
+        idleRemove(set, server);
+}
+
+static inline void markIdle(IdleSet *set, int server)
+{
+    if (MODEL_SERVERS == 1)
+        set->count = 1;
+    else
+        idleAdd(set, server);
+}
+
+/*******************************************************************************
+*       simulate(const Params *p, int rep, Stats *st)
+********************************************************************************
+* Function that runs one replication of the simulation. Idle servers depart
+* at INFINITY, so the next event is the earliest of the next arrival and the
+* root of the departure heap. With warm-up deletion, the statistics are kept
+* in segments of SERIES_SEGMENT batches of the response times (the periods in
+* progress are split between two segments), and every SERIES_CHECK batches
+* MSER-5 looks for the end of the warm-up. Once it lies in the first half of
+* the series, the statistics restart at the first segment after it (so at
+* least the warm-up is deleted); with a precision the run then stops at the
+* first check where the batch means interval of the mean response time is
+* narrow enough.
+* - Input: *p (inputs of the simulation)
+*           rep (index of the replication, selects its random streams)
+* - Output: *st (outputs of the replication)
+*******************************************************************************/
+void simulate(const Params *p, int rep, Stats *st)
+{
+#ifdef PROBES
+    Probes before = probes;             // Counters of the thread before the run
+    unsigned long allocStart = allocCount, allocBytesStart = allocBytes;
+#endif
+    int c = (MODEL_SERVERS > 0) ? MODEL_SERVERS : p->c;   // Number of servers in the system
+    Rng streams[NUM_STREAMS];           // Arrival, service and dispatch streams
+    Arrivals arrivals;                  // Process of the arrivals
+    Sampler servStream;                 // Block of service times
+
+    double time = 0.0;                  // Current Simulation time
+    double nextArrival = 0.0;           // Time for next arrival
+    double nextService = 0.0;           // Service time of the next arrival (replay)
+    double lastEventTime = 0.0;         // Variable for "last event time"
+    double lastBusyTime = -1;           // Start of the full busy period, -1 if none
+    double pkgIdleStart = 0.0;          // Start of the package idle period, -1 if none
+    double warmupEnd = 0.0;             // End of the deleted warm-up
+    double statsFrom = 0.0;             // Start of the outputs of st
+    bool steady = !p->warmup;           // Warm-up over (or not looked for)
+    Series series;                      // Batch means of the response time
+    Segments *segments = NULL;          // Outputs of the warm-up (-w)
+    unsigned long n = 0;                // Actual number of customers in the system
+
+    double *departure = (double*)malloc(c * sizeof(double));  // Departure time per server
+    double *idleStart = (double*)malloc(c * sizeof(double));  // Start of idle period per core, -1 if busy
+    double *jobArrival = (double*)malloc(c * sizeof(double)); // Arrival time of the customer in service
+    int queues = (MODEL_QUEUE == QUEUE_PER_SERVER) ? c : 1;
+    Fifo *jobsQueue = (Fifo*)malloc(queues * sizeof(Fifo));  // Arrival time of the queued jobs
+    Fifo *sizeQueue = (Fifo*)malloc(queues * sizeof(Fifo));  // Service time of the queued jobs (lwl, replay)
+    DepHeap depHeap;                    // Servers ordered by departure time
+    IdleSet idleServers;                // Servers not serving any customer
+    CStates cstates;                    // Idle states of the cores (-L)
+    bool sleeping = MODEL_POWER && p->idlePolicy != CPOLICY_OFF;
+    CStates pkgCStates;                 // Idle states of the package (-K)
+    bool pkgSleeping = MODEL_POWER && p->pkgPolicy != CPOLICY_OFF;
+    PStates pstates;                    // Frequencies of the cores (-F)
+    bool scaling = MODEL_POWER && p->governor.type != GOV_OFF;
+    Dispatch dispatch;                  // Load-balancing policy (QUEUE_PER_SERVER)
+    Trace trace;                        // Event trace (-t)
+    bool tracing = (p->traceFile != NULL && rep == 0);
+    Replay replay;                      // Log of jobs replayed (-r)
+    bool replaying = (p->replayFile != NULL);
+    bool sized;                         // Service times known on arrival
+
+    if (p->warmup)
+        segments = (Segments*)malloc(sizeof(Segments));
+    if (!departure || !idleStart || !jobArrival || !jobsQueue || !sizeQueue ||
+        (p->warmup && !segments)) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < c; i++)
+    {
+        departure[i] = INFINITY;
+        idleStart[i] = 0.0;
+    }
+    for (int i = 0; i < queues; i++)
+    {
+        fifoInit(&jobsQueue[i]);
+        fifoInit(&sizeQueue[i]);
+    }
+    heapInit(&depHeap, departure, c);
+    idleInit(&idleServers, c);
+    if (MODEL_POWER)
+    {
+        cstateInit(&cstates, &p->cstates, p->idlePolicy, p->idleState, c);
+        cstateInit(&pkgCStates, &p->pkgCStates, p->pkgPolicy, p->pkgLimit, 1);
+        pstateInit(&pstates, &p->pstates, &p->governor, c);
+    }
+    statsInit(st, p);
+
+    rngStreams(streams, p->seed, rep);
+    dispatchInit(&dispatch, p->policy, p->d, c, &streams[STREAM_DISPATCH], &idleServers);
+    seriesInit(&series);
+    if (segments)
+        segments->n = 0;
+    arrivalInit(&arrivals, &p->arrivals, p->arrTime, &streams[STREAM_ARRIVAL]);
+    samplerInit(&servStream, &p->service, p->departTime, &streams[STREAM_SERVICE]);
+    sized = replaying || (MODEL_QUEUE == QUEUE_PER_SERVER && dispatch.needSize);
+    if (replaying)
+    {
+        replayOpen(&replay, p->replayFile, p->replayScale, TIME_UNIT);
+        if (!replayNext(&replay, &nextArrival, &nextService))
+            nextArrival = INFINITY;
+    }
+    if (tracing)
+    {
+        traceOpen(&trace, p->traceFile, c, TIME_UNIT);
+        for (int i = 0; i < c; i++)
+            traceAdd(&trace, TRACE_CORE_IDLE_ENTER, 0.0, i, -1);
+        traceAdd(&trace, TRACE_PKG_IDLE_ENTER, 0.0, TRACE_NONE, -1);
+    }
+
+    SimState state = { .streams = streams, .arrivals = &arrivals, .servStream = &servStream,
+                       .departure = departure, .idleStart = idleStart, .jobArrival = jobArrival,
+                       .jobsQueue = jobsQueue, .sizeQueue = sizeQueue, .queues = queues,
+                       .depHeap = &depHeap, .idleServers = &idleServers, .cstates = &cstates,
+                       .pkgCStates = &pkgCStates, .pstates = &pstates, .dispatch = &dispatch,
+                       .series = &series, .segments = segments,
+                       .replay = replaying ? &replay : NULL, .st = st };
+    double nextCkpt = wallTime() + p->ckptInterval; // Wall-clock time of the next checkpoint
+    unsigned int events = 0;            // Events since the last look at the clock
+    if (p->resume)
+    {
+        simCkpt(p, rep, &state, false);
+        time = state.time;
+        nextArrival = state.nextArrival;
+        nextService = state.nextService;
+        lastEventTime = state.lastEventTime;
+        lastBusyTime = state.lastBusyTime;
+        pkgIdleStart = state.pkgIdleStart;
+        warmupEnd = state.warmupEnd;
+        statsFrom = state.statsFrom;
+        steady = state.steady;
+        n = state.n;
+    }
+
+    // Simulation loop
+#ifdef PROBE_TIMING
+    uint64_t loopStart = probeTsc();
+#endif
+    while (time < p->endTime)
+    {
+        int server;
+        double service = 0.0;
+
+        probeTime(PHASE_MIN, server = nextDeparture(&depHeap));
+
+        if (p->ckptFile && ++events == CKPT_EVENTS)
+        {
+            events = 0;
+            if (wallTime() >= nextCkpt)
+            {
+                simSave(p, rep, &state, time, nextArrival, nextService, lastEventTime,
+                        lastBusyTime, pkgIdleStart, warmupEnd, statsFrom, steady, n);
+                nextCkpt = wallTime() + p->ckptInterval;
+            }
+        }
+
+        if (nextArrival == INFINITY && departure[server] == INFINITY)
+            break;      // End of the replayed log, every job served
+
+        // Arrival occurred
+        if (nextArrival < departure[server])
+        {
+            time = nextArrival;
+            probeCount(PROBE_ARRIVAL);
+            probeTime(PHASE_RNG,
+                if (replaying)
+                {
+                    service = nextService;
+                    if (!replayNext(&replay, &nextArrival, &nextService))
+                        nextArrival = INFINITY;
+                }
+                else
+                    nextArrival = arrivalNext(&arrivals, time));
+            probeTime(PHASE_STATS,
+                st->s += n * (time - lastEventTime);  // Update area under "s" curve
+                lastEventTime = time;
+                st->arrived++;
+                if (KEEP_SAMPLES)
+                    sampleAdd(&st->arrivalPeriods, nextArrival - time));
+            if (tracing)
+                traceAdd(&trace, TRACE_ARRIVAL, time, TRACE_NONE, time);
+
+            if (MODEL_CAPACITY && n >= (unsigned long)p->k)
+            {
+                probeCount(PROBE_DROP);
+                st->dropped++;  // System is full, the customer is lost
+                if (tracing)
+                    traceAdd(&trace, TRACE_DROP, time, TRACE_NONE, time);
+                continue;
+            }
+            n++;
+
+            if (MODEL_QUEUE == QUEUE_PER_SERVER)
+            {
+                if (dispatch.needSize && !replaying)
+                    probeTime(PHASE_RNG, service = sampleNext(&servStream));
+                probeTime(PHASE_DISPATCH,
+                    server = dispatchPick(&dispatch);
+                    dispatchArrive(&dispatch, server, time, service));
+                if (tracing)
+                    traceAdd(&trace, TRACE_DISPATCH, time, server, time);
+                if (!idleHas(&idleServers, server))
+                {
+                    probeCount(PROBE_QUEUED);
+                    st->waited++;
+                    probeTime(PHASE_QUEUE,
+                        fifoPush(&jobsQueue[server], time);
+                        if (sized)
+                            fifoPush(&sizeQueue[server], service));
+                    continue;
+                }
+            }
+            else
+            {
+                if (idleServers.count == 0)
+                {
+                    probeCount(PROBE_QUEUED);
+                    st->waited++;
+                    probeTime(PHASE_QUEUE,
+                        fifoPush(&jobsQueue[0], time);
+                        if (sized)
+                            fifoPush(&sizeQueue[0], service));
+                    continue;
+                }
+                if (MODEL_SERVERS == 1)
+                    server = 0;
+                else
+                    probeTime(PHASE_DISPATCH,
+                        server = idleAt(&idleServers, rngBelow(&streams[STREAM_DISPATCH], idleServers.count)));
+                if (tracing)
+                    traceAdd(&trace, TRACE_DISPATCH, time, server, time);
+            }
+
+            // The server starts serving the customer
+            if (tracing)
+            {
+                if (idleServers.count == c)
+                    traceAdd(&trace, TRACE_PKG_IDLE_EXIT, time, TRACE_NONE, -1);
+                traceAdd(&trace, TRACE_CORE_IDLE_EXIT, time, server, -1);
+                traceAdd(&trace, TRACE_SERVICE_START, time, server, time);
+            }
+            if ((MODEL_STATS & STAT_PKG_IDLE) && idleServers.count == c)
+            {
+                probeTime(PHASE_STATS,
+                    if (time - pkgIdleStart != 0)
+                    {
+                        histAdd(&st->packageIdlePeriods, time - pkgIdleStart);
+                        edgeAdd(&st->pkgIdleDistr, time - pkgIdleStart);
+                    });
+                pkgIdleStart = -1;
+            }
+            if (!sized)
+                probeTime(PHASE_RNG, service = sampleNext(&servStream));
+            double work = service;
+            if (scaling)        // The governor picks the frequency of the core
+            {
+                probeTime(PHASE_STATS, service *= pstateJob(&pstates, &st->pstates, server, time, false));
+                pstateBusy(&pstates, &st->pstates, server, service);
+            }
+            if (pkgSleeping && idleServers.count == c)  // ... and first for the package
+                probeTime(PHASE_STATS, service += cstateWake(&pkgCStates, &st->pkgCStates, 0, time, statsFrom));
+            if (sleeping)       // The job waits for the core to wake up
+                probeTime(PHASE_STATS, service += cstateWake(&cstates, &st->cstates, server, time, statsFrom));
+            if (MODEL_QUEUE == QUEUE_PER_SERVER && (scaling || sleeping || pkgSleeping))
+                dispatchStretch(&dispatch, server, service - work);
+            probeTime(PHASE_MIN, setDeparture(&depHeap, server, time + service));
+            probeTime(PHASE_DISPATCH, markBusy(&idleServers, server));
+            jobArrival[server] = time;
+            probeTime(PHASE_STATS,
+                histAdd(&st->waitTimes, 0.0);
+                st->busyTimeAll += departure[server] - time;
+                if (KEEP_SAMPLES)
+                {
+                    sampleAdd(&st->servicePeriods, departure[server] - time);
+                    sampleAdd(&st->arrivalsPerCore[server], time);
+                }
+                if (time - idleStart[server] != 0)
+                {
+                    double idle = time - idleStart[server];
+                    st->idleTimeAll += idle;
+                    if (MODEL_STATS & STAT_CORE_IDLE)
+                    {
+                        histAdd(&st->coreidlePeriods, idle);
+                        edgeAdd(&st->coreIdleDistr, idle);
+                    }
+                    if (MODEL_STATS & STAT_PER_CORE)
+                        edgeAdd(&st->coreIdleDistrPerCore[server], idle);
+                });
+            idleStart[server] = -1;
+            if (idleServers.count == 0)
+                lastBusyTime = time;    // Every server busy: full busy period starts
+        }
+        // Departure occurred
+        else
+        {
+            bool full = (idleServers.count == 0);
+            Fifo *queue = &jobsQueue[(MODEL_QUEUE == QUEUE_PER_SERVER) ? server : 0];
+
+            time = departure[server];
+            double response = time - jobArrival[server];
+            probeCount(PROBE_DEPARTURE);
+            probeTime(PHASE_STATS,
+                st->s += n * (time - lastEventTime);  // Update area under "s" curve
+                lastEventTime = time;
+                st->departures++;
+                st->arrivals[server]++;
+                histAdd(&st->responseTimes, response));
+            n--;
+            if (MODEL_QUEUE == QUEUE_PER_SERVER)
+                probeTime(PHASE_DISPATCH, dispatchDepart(&dispatch, server));
+            if (tracing)
+                traceAdd(&trace, TRACE_DEPARTURE, time, server, jobArrival[server]);
+
+            double nextjob;
+            probeTime(PHASE_QUEUE, nextjob = fifoPop(queue));
+            if (nextjob != -1)
+            {
+                // The server takes the next customer of its queue
+                if (sized)
+                    probeTime(PHASE_QUEUE, service = fifoPop(&sizeQueue[(MODEL_QUEUE == QUEUE_PER_SERVER) ? server : 0]));
+                else
+                    probeTime(PHASE_RNG, service = sampleNext(&servStream));
+                if (scaling)
+                {
+                    double work = service;
+                    probeTime(PHASE_STATS, service *= pstateJob(&pstates, &st->pstates, server, time, true));
+                    pstateBusy(&pstates, &st->pstates, server, service);
+                    if (MODEL_QUEUE == QUEUE_PER_SERVER)
+                        dispatchStretch(&dispatch, server, service - work);
+                }
+                probeTime(PHASE_MIN, setDeparture(&depHeap, server, time + service));
+                jobArrival[server] = nextjob;
+                if (tracing)
+                {
+                    if (MODEL_QUEUE == QUEUE_SHARED)
+                        traceAdd(&trace, TRACE_DISPATCH, time, server, nextjob);
+                    traceAdd(&trace, TRACE_SERVICE_START, time, server, nextjob);
+                }
+                probeTime(PHASE_STATS,
+                    histAdd(&st->waitTimes, time - nextjob);
+                    st->busyTimeAll += departure[server] - time;
+                    if (KEEP_SAMPLES)
+                    {
+                        sampleAdd(&st->servicePeriods, departure[server] - time);
+                        sampleAdd(&st->arrivalsPerCore[server], nextjob);
+                    });
+            }
+            else
+            {
+                probeCount(PROBE_IDLE);
+                probeTime(PHASE_MIN, setDeparture(&depHeap, server, INFINITY));  // Set server as empty
+                probeTime(PHASE_DISPATCH, markIdle(&idleServers, server));
+                idleStart[server] = time;
+                if (sleeping)
+                    cstateSleep(&cstates, server, time);
+                if (scaling)
+                    pstateIdle(&pstates, server, time);
+                if (full)
+                {
+                    probeTime(PHASE_STATS,
+                        st->busyTime += time - lastBusyTime;
+                        if (MODEL_STATS & STAT_FULL_BUSY)
+                            histAdd(&st->fullBusyPeriods, time - lastBusyTime));
+                    lastBusyTime = -1;
+                }
+                if (idleServers.count == c)
+                {
+                    pkgIdleStart = time;
+                    if (pkgSleeping)
+                        cstateSleep(&pkgCStates, 0, time);
+                }
+                if (tracing)
+                {
+                    traceAdd(&trace, TRACE_CORE_IDLE_ENTER, time, server, -1);
+                    if (idleServers.count == c)
+                        traceAdd(&trace, TRACE_PKG_IDLE_ENTER, time, TRACE_NONE, -1);
+                }
+            }
+
+            // Output analysis of the response time (warm-up and precision)
+            if (p->warmup && seriesAdd(&series, response))
+            {
+                if (!steady && series.n % SERIES_SEGMENT == 0)
+                {
+                    // Close the segment of the warm-up: the time of the
+                    // periods in progress is split at this moment, the
+                    // periods themselves are counted where they end
+                    if (segments->n == WARMUP_SEGMENTS)
+                    {
+                        // The series has merged its batches, so do the segments
+                        for (int j = 0; j < WARMUP_SEGMENTS / 2; j++)
+                        {
+                            statsAppend(&segments->st[2 * j], &segments->st[2 * j + 1]);
+                            statsMove(&segments->st[j], &segments->st[2 * j]);
+                            segments->start[j] = segments->start[2 * j];
+                        }
+                        segments->n = WARMUP_SEGMENTS / 2;
+                    }
+                    Stats *prev = &segments->st[segments->n];
+                    statsMove(prev, st);
+                    statsInit(st, p);
+                    for (int i = 0; i < c; i++)
+                    {
+                        if (idleStart[i] != -1)
+                        {
+                            prev->idleTimeAll += time - idleStart[i];
+                            st->idleTimeAll -= time - idleStart[i];
+                            if (sleeping)
+                                cstateIdle(&cstates, &prev->cstates, i, time, statsFrom);
+                        }
+                        else
+                        {
+                            prev->busyTimeAll -= departure[i] - time;
+                            st->busyTimeAll += departure[i] - time;
+                            if (scaling)
+                            {
+                                pstateBusy(&pstates, &prev->pstates, i, time - departure[i]);
+                                pstateBusy(&pstates, &st->pstates, i, departure[i] - time);
+                            }
+                        }
+                    }
+                    if (pkgSleeping && idleServers.count == c)
+                        cstateIdle(&pkgCStates, &prev->pkgCStates, 0, time, statsFrom);
+                    if (lastBusyTime != -1)
+                    {
+                        prev->busyTime += time - lastBusyTime;
+                        st->busyTime -= time - lastBusyTime;
+                    }
+                    segments->start[segments->n++] = statsFrom;
+                    statsFrom = time;
+                }
+                if (series.n % SERIES_CHECK == 0)
+                {
+                    int d;
+                    if (!steady && (d = mserTruncation(&series)) < series.n / 2)
+                    {
+                        // Warm-up over: restart every statistic at the first
+                        // segment that starts after the truncation point
+                        int k = (d + SERIES_SEGMENT - 1) / SERIES_SEGMENT;
+                        warmupEnd = segmentsRestart(segments, k, st, statsFrom);
+                        seriesDrop(&series, k * SERIES_SEGMENT);
+                        steady = true;
+                    }
+                    else if (steady && p->precision > 0 && seriesPrecise(&series, p->precision))
+                        break;
+                }
+            }
+        }
+    }
+#ifdef PROBE_TIMING
+    probes.cycles[PHASE_LOOP] += probeTsc() - loopStart;
+#endif
+    if (p->ckptFile)
+        simSave(p, rep, &state, time, nextArrival, nextService, lastEventTime,
+                lastBusyTime, pkgIdleStart, warmupEnd, statsFrom, steady, n);
+    if (sleeping)       // Account for the cores still idle
+        for (int i = 0; i < c; i++)
+            if (idleStart[i] != -1)
+                cstateIdle(&cstates, &st->cstates, i, time, statsFrom);
+    if (pkgSleeping && idleServers.count == c)
+        cstateIdle(&pkgCStates, &st->pkgCStates, 0, time, statsFrom);
+    if (!steady)        // No warm-up found: every segment is kept
+        segmentsRestart(segments, 0, st, statsFrom);
+    st->warmupTime = warmupEnd;
+    st->time = time - warmupEnd;
+    if (p->warmup)
+        seriesEstimate(&series, &st->responseMean);
+    if (tracing)
+        traceClose(&trace);
+    if (replaying)
+        replayClose(&replay);
+
+    for (int i = 0; i < queues; i++)
+    {
+        fifoFree(&jobsQueue[i]);
+        fifoFree(&sizeQueue[i]);
+    }
+    heapFree(&depHeap);
+    idleFree(&idleServers);
+    if (MODEL_POWER)
+    {
+        cstateFree(&cstates);
+        cstateFree(&pkgCStates);
+        pstateFree(&pstates);
+    }
+    dispatchFree(&dispatch);
+    free(jobsQueue);
+    free(sizeQueue);
+    free(departure);
+    free(idleStart);
+    free(jobArrival);
+    free(segments);
+#ifdef PROBES
+    probeSince(&st->probes, &before);
+    st->probes.count[PROBE_ALLOC] = allocCount - allocStart;
+    st->probes.count[PROBE_ALLOC_BYTES] = allocBytes - allocBytesStart;
+#endif
+}
+
+/*******************************************************************************
+*       runOne(void *ctx, int rep)
+********************************************************************************
+* Function run by the thread pool for each replication of a single point
+* - Input: ctx (Run shared by the replications)
+*           rep (index of the replication)
+*******************************************************************************/
+void runOne(void *ctx, int rep)
+{
+    Run *run = (Run*)ctx;
+    simulate(run->p, rep, &run->stats[rep]);
+}
+
+/*******************************************************************************
+*       statsEstimates(Stats stats[], int reps, Estimate est[])
+********************************************************************************
+* Function that estimates the main outputs over the replications (rates and
+* sojourn times in seconds, utilizations in %)
+* - Input: stats (outputs of each replication)
+*           reps (number of replications)
+* - Output: est (estimates, indexed by EST_*, then one per core idle fraction)
+*           int (number of estimates)
+*******************************************************************************/
+int statsEstimates(Stats stats[], int reps, Estimate est[])
+{
+    const Edges *edges = stats[0].coreIdleDistr.edges;
+    int count = (MODEL_STATS & STAT_CORE_IDLE) ? EST_IDLE + edges->n + 1 : EST_IDLE;
+
+    for (int k = 0; k < count; k++)
+        estInit(&est[k]);
+    for (int r = 0; r < reps; r++)
+    {
+        Stats *st = &stats[r];
+        estAdd(&est[EST_THROUGHPUT], st->departures / (st->time * TIME_UNIT));
+        estAdd(&est[EST_UTILIZATION], 100.0 * st->busyTime / st->time);
+        estAdd(&est[EST_CUSTOMERS], st->s / st->time);
+        estAdd(&est[EST_SOJOURN], st->s / st->departures * TIME_UNIT);
+        estAdd(&est[EST_AVG_UTILIZATION], 100.0 * st->busyTimeAll / (st->idleTimeAll + st->busyTimeAll));
+        estAdd(&est[EST_BLOCKING], 100.0 * st->dropped / st->arrived);
+        estAdd(&est[EST_WAITING], 100.0 * st->waited / (st->arrived - st->dropped));
+        estAdd(&est[EST_RESPONSE_P50], histQuantile(&st->responseTimes, 0.50) * TIME_UNIT);
+        estAdd(&est[EST_RESPONSE_P99], histQuantile(&st->responseTimes, 0.99) * TIME_UNIT);
+        estAdd(&est[EST_RESPONSE_P999], histQuantile(&st->responseTimes, 0.999) * TIME_UNIT);
+        estAdd(&est[EST_WARMUP], st->warmupTime * TIME_UNIT);
+        estAdd(&est[EST_RUN_LENGTH], st->time * TIME_UNIT);
+        if (MODEL_STATS & STAT_CORE_IDLE)
+        {
+            for (int k = 0; k < edges->n; k++)
+                estAdd(&est[EST_IDLE + k], st->coreIdleDistr.below[k] / st->idleTimeAll);
+            estAdd(&est[EST_IDLE + edges->n], st->coreIdleDistr.total / st->idleTimeAll);
+        }
+    }
+    return count;
+}
+
+/*******************************************************************************
+*       edgeLabel(char *label, const char *prefix, double edge)
+********************************************************************************
+* Function that formats the label of an edge, converted to us
+* - Input: prefix (text before the edge)
+*           edge (edge in the unit of time of the model)
+* - Output: label (formatted label)
+*******************************************************************************/
+void edgeLabel(char *label, const char *prefix, double edge)
+{
+    sprintf(label, "%s%gus", prefix, edge * TIME_UNIT * 1000000);
+}
+
+/*******************************************************************************
+*       printCI(Stats stats[], int reps)
+********************************************************************************
+* Function that prints the mean and confidence interval of the main outputs
+* over the replications
+* - Input: stats (outputs of each replication)
+*           reps (number of replications)
+*******************************************************************************/
+void printCI(Stats stats[], int reps)
+{
+    Estimate est[EST_IDLE + MAX_EDGES + 1];
+    const Edges *edges = stats[0].coreIdleDistr.edges;
+    char label[48];
+
+    statsEstimates(stats, reps, est);
+
+    printf("<-------------------------------------------------------------> \n");
+    printf("-  CONFIDENCE INTERVALS (%d replications, %s): \n", reps, CI_LEVEL);
+    printEstimate("Throughput rate", &est[EST_THROUGHPUT], "cust/sec");
+    printEstimate("Server utilization", &est[EST_UTILIZATION], (stats[0].c > 1) ? "% (time system is full busy)" : "%");
+    printEstimate("Avg # of cust. in system", &est[EST_CUSTOMERS], "cust");
+    printEstimate("Mean Sojourn time", &est[EST_SOJOURN], "sec");
+    if (stats[0].c > 1)
+        printEstimate("Average utilization", &est[EST_AVG_UTILIZATION], "%");
+    if (MODEL_CAPACITY)
+        printEstimate("Blocking probability", &est[EST_BLOCKING], "%");
+    printEstimate("Response time p50", &est[EST_RESPONSE_P50], "sec");
+    printEstimate("Response time p99", &est[EST_RESPONSE_P99], "sec");
+    printEstimate("Response time p99.9", &est[EST_RESPONSE_P999], "sec");
+    if (stats[0].warmup)
+    {
+        printEstimate("Warm-up deleted", &est[EST_WARMUP], "sec");
+        printEstimate("Simulated time kept", &est[EST_RUN_LENGTH], "sec");
+    }
+    if (MODEL_STATS & STAT_CORE_IDLE)
+    {
+        for (int k = 0; k < edges->n; k++)
+        {
+            edgeLabel(label, "% core idle < ", edges->at[k]);
+            printEstimate(label, &est[EST_IDLE + k], "");
+        }
+        edgeLabel(label, "% core idle > ", edges->at[edges->n - 1]);
+        printEstimate(label, &est[EST_IDLE + edges->n], "");
+    }
+}
+
+/*******************************************************************************
+*       fillFields(Record *rec, const Params *p, Estimate est[], int reps)
+********************************************************************************
+* Function that fills the record of one point: its inputs, then the mean and
+* CI half width of each output. Every model writes the same fields, in SI
+* units (times in seconds, rates in cust/sec, utilizations in %); the fields
+* a model does not collect are NaN.
+* - Input: *p (inputs of the point)
+*           est (outputs, as given by statsEstimates())
+*           reps (number of replications, 0 for a closed form)
+* - Output: *rec (record of the point)
+*******************************************************************************/
+void fillFields(Record *rec, const Params *p, Estimate est[], int reps)
+{
+    char name[48];
+
+    recordInit(rec);
+    recordText(rec, "model", MODEL_NAME);
+    recordText(rec, "policy", (MODEL_QUEUE == QUEUE_PER_SERVER) ? policyNames[p->policy] : "shared");
+    recordValue(rec, "arr_time", p->arrTime * TIME_UNIT);
+    recordText(rec, "arrivals", p->replayFile ? "replay" : p->arrivals.name);
+    recordValue(rec, "serv_time", p->departTime * TIME_UNIT);
+    recordText(rec, "service", p->replayFile ? "replay" : p->service.name);
+    recordValue(rec, "servers", p->c);
+    recordValue(rec, "capacity", MODEL_CAPACITY ? p->k : NAN);
+    recordValue(rec, "load", p->departTime / (p->arrTime * p->c));
+    recordValue(rec, "sim_time", p->endTime * TIME_UNIT);
+    recordInteger(rec, "seed", p->seed);
+    recordValue(rec, "reps", reps);
+    for (int k = 0; k < EST_IDLE; k++)
+        recordEstimate(rec, estNames[k], &est[k]);
+    for (int k = 0; k <= p->coreEdges.n; k++)
+    {
+        if (k < p->coreEdges.n)
+            edgeLabel(name, "core_idle_lt_", p->coreEdges.at[k]);
+        else
+            sprintf(name, "core_idle_all");
+        if (MODEL_STATS & STAT_CORE_IDLE)
+            recordEstimate(rec, name, &est[EST_IDLE + k]);
+        else
+        {
+            recordValue(rec, name, NAN);
+            strcat(name, "_ci");
+            recordValue(rec, name, NAN);
+        }
+    }
+}
+
+/*******************************************************************************
+*       idlePolicyName(const Params *p)
+********************************************************************************
+* Function that returns the name of the idle policy of the cores
+* - Input: *p (inputs of the point)
+* - Output: const char* (name of the policy, or of the state it always enters)
+*******************************************************************************/
+const char *idlePolicyName(const Params *p)
+{
+    if (p->idlePolicy == CPOLICY_FIXED)
+        return p->cstates.name[p->idleState];
+    return cpolicyNames[p->idlePolicy];
+}
+
+/*******************************************************************************
+*       pkgPolicyName(const Params *p)
+********************************************************************************
+* Function that returns the name of the policy of the package
+* - Input: *p (inputs of the point)
+* - Output: const char* (off, auto, or the deepest state allowed)
+*******************************************************************************/
+const char *pkgPolicyName(const Params *p)
+{
+    if (p->pkgPolicy == CPOLICY_OFF)
+        return "off";
+    if (p->pkgLimit == p->pkgCStates.n - 1)
+        return "auto";
+    return p->pkgCStates.name[p->pkgLimit];
+}
+
+/*******************************************************************************
+*       corePower(const Params *p, const Stats *st)
+********************************************************************************
+* Function that computes the mean power of a core: busy at its frequencies
+* (C0 without -F), idle in its idle states (C0 without -L)
+* - Input: *p (inputs of the point)
+*           *st (outputs)
+* - Output: double (power in W)
+*******************************************************************************/
+double corePower(const Params *p, const Stats *st)
+{
+    double power = (p->idlePolicy != CPOLICY_OFF) ? cstatePower(&p->cstates, &st->cstates, -1, st->time)
+                                                  : p->cstates.power[0];
+    double busy = 0.0;
+
+    if (p->governor.type == GOV_OFF)
+        return power;
+    for (int l = 0; l < p->pstates.n; l++)
+        busy += st->pstates.time[l];
+    // The busy time at C0 power is replaced by the busy time at each frequency
+    return power + (pstateEnergy(&p->pstates, &st->pstates) - busy * p->cstates.power[0])
+                   / (st->time * p->c);
+}
+
+/*******************************************************************************
+*       powerFields(Record *rec, const Params *p, const char *prefix,
+*                   const CStateTable *t, const char *policy, Stats stats[],
+*                   int reps, bool package)
+********************************************************************************
+* Function that appends the idle states of the cores or of the package to the
+* record of a point: their policy, then the power of a core (see corePower())
+* or the uncore power (W), the wake-up latency per job (s) and the residency
+* of each state (%), with their CI half widths, named <prefix>_...
+* - Input: *p (inputs of the point)
+*           prefix (start of the names of the fields)
+*           *t (table of the states)
+*           policy (name of the policy)
+*           stats (outputs of each replication of the point)
+*           reps (number of replications)
+*           package (the states of the package, else of the cores)
+* - Output: *rec (record of the point)
+*******************************************************************************/
+void powerFields(Record *rec, const Params *p, const char *prefix, const CStateTable *t,
+                 const char *policy, Stats stats[], int reps, bool package)
+{
+    Estimate power, latency, residency[CSTATE_MAX];
+    char name[48];
+
+    estInit(&power);
+    estInit(&latency);
+    for (int s = 0; s < t->n; s++)
+        estInit(&residency[s]);
+    for (int r = 0; r < reps; r++)
+    {
+        const CStateStats *cst = package ? &stats[r].pkgCStates : &stats[r].cstates;
+        double total = stats[r].time * cst->c, asleep = 0.0;
+
+        estAdd(&power, package ? cstatePower(t, cst, -1, stats[r].time) : corePower(p, &stats[r]));
+        estAdd(&latency, cst->latency / stats[r].departures * TIME_UNIT);
+        for (int s = 1; s < t->n; s++)
+        {
+            estAdd(&residency[s], 100.0 * cst->time[s] / total);
+            asleep += cst->time[s];
+        }
+        estAdd(&residency[0], 100.0 * (total - asleep) / total);
+    }
+    sprintf(name, "%s_policy", prefix);
+    recordText(rec, name, policy);
+    sprintf(name, "%s_power", prefix);
+    recordEstimate(rec, name, &power);
+    sprintf(name, "%s_latency", prefix);
+    recordEstimate(rec, name, &latency);
+    for (int s = 0; s < t->n; s++)
+    {
+        sprintf(name, "%s_%s", prefix, t->name[s]);
+        recordEstimate(rec, name, &residency[s]);
+    }
+}
+
+/*******************************************************************************
+*       freqFields(Record *rec, const Params *p, Stats stats[], int reps)
+********************************************************************************
+* Function that appends the frequencies of the cores to the record of a point:
+* the governor, then the power of a core (W, see corePower()), the changes of
+* frequency per job and the busy time at each frequency (% of the busy time),
+* with their CI half widths, named freq_...
+* - Input: *p (inputs of the point)
+*           stats (outputs of each replication of the point)
+*           reps (number of replications)
+* - Output: *rec (record of the point)
+*******************************************************************************/
+void freqFields(Record *rec, const Params *p, Stats stats[], int reps)
+{
+    const PStateTable *t = &p->pstates;
+    Estimate power, changes, busy[PSTATE_MAX];
+    char name[48];
+
+    estInit(&power);
+    estInit(&changes);
+    for (int l = 0; l < t->n; l++)
+        estInit(&busy[l]);
+    for (int r = 0; r < reps; r++)
+    {
+        const PStateStats *pst = &stats[r].pstates;
+        double total = 0.0;
+
+        for (int l = 0; l < t->n; l++)
+            total += pst->time[l];
+        estAdd(&power, corePower(p, &stats[r]));
+        estAdd(&changes, (double)pst->changes / stats[r].departures);
+        for (int l = 0; l < t->n; l++)
+            estAdd(&busy[l], 100.0 * pst->time[l] / total);
+    }
+    recordText(rec, "freq_governor", p->governor.name);
+    recordEstimate(rec, "freq_power", &power);
+    recordEstimate(rec, "freq_changes", &changes);
+    for (int l = 0; l < t->n; l++)
+    {
+        sprintf(name, "freq_%g", t->freq[l]);
+        recordEstimate(rec, name, &busy[l]);
+    }
+}
+
+/*******************************************************************************
+*       fillRecord(Record *rec, const Params *p, Stats stats[], int reps)
+********************************************************************************
+* Function that fills the record of a simulated point (see fillFields()).
+* With idle states (-L, -K) or frequencies (-F), the power outputs follow
+* (see powerFields() and freqFields()).
+* Builds with -DPROBES (-DPROBE_TIMING) append the counters (cycles) of the
+* replications, see probe.h.
+* - Input: *p (inputs of the point)
+*           stats (outputs of each replication of the point)
+*           reps (number of replications)
+* - Output: *rec (record of the point)
+*******************************************************************************/
+void fillRecord(Record *rec, const Params *p, Stats stats[], int reps)
+{
+    Estimate est[EST_IDLE + MAX_EDGES + 1];
+
+    statsEstimates(stats, reps, est);
+    fillFields(rec, p, est, reps);
+    if (MODEL_POWER && p->idlePolicy != CPOLICY_OFF)
+        powerFields(rec, p, "core", &p->cstates, idlePolicyName(p), stats, reps, false);
+    if (MODEL_POWER && p->pkgPolicy != CPOLICY_OFF)
+        powerFields(rec, p, "pkg", &p->pkgCStates, pkgPolicyName(p), stats, reps, true);
+    if (MODEL_POWER && p->governor.type != GOV_OFF)
+        freqFields(rec, p, stats, reps);
+#ifdef PROBES
+    char name[48];
+    Probes total = {0};
+    for (int r = 0; r < reps; r++)
+        probeMerge(&total, &stats[r].probes);
+    for (int k = 0; k < NUM_PROBES; k++)
+    {
+        sprintf(name, "probe_%s", probeNames[k]);
+        recordValue(rec, name, total.count[k]);
+    }
+#ifdef PROBE_TIMING
+    for (int k = 0; k < NUM_PHASES; k++)
+    {
+        sprintf(name, "cycles_%s", phaseNames[k]);
+        recordValue(rec, name, total.cycles[k]);
+    }
+#endif
+#endif
+}
+
+/*******************************************************************************
+*       theoryPoint(const Params *p, Theory *t)
+********************************************************************************
+* Function that computes the closed form of a point, if the model has one:
+* M/M/c for a shared queue, M/M/1/K for a single server with a capacity, and
+* c M/M/1 queues for per-server queues with random dispatch (Poisson arrivals
+* and exponential services only, no replay, idle states or frequencies)
+* - Input: *p (inputs of the point)
+* - Output: *t (steady-state outputs, in the unit of the model)
+*           bool (false if the point has no closed form or is unstable)
+*******************************************************************************/
+bool theoryPoint(const Params *p, Theory *t)
+{
+    double lambda = 1.0 / p->arrTime, mu = 1.0 / p->departTime;
+
+    if (p->replayFile || p->service.type != DISTR_EXP || p->arrivals.type != ARRIVAL_POISSON
+        || p->idlePolicy != CPOLICY_OFF || p->pkgPolicy != CPOLICY_OFF || p->governor.type != GOV_OFF)
+        return false;
+    if (MODEL_CAPACITY)
+        return p->c == 1 && theoryMM1K(lambda, mu, p->k, t);
+    if (MODEL_QUEUE == QUEUE_PER_SERVER)
+        return p->policy == POLICY_RANDOM && theorySplit(lambda, mu, p->c, t);
+    return theoryMMc(lambda, mu, p->c, t);
+}
+
+/*******************************************************************************
+*       theoryEstimates(const Theory *t, const Params *p, Estimate est[])
+********************************************************************************
+* Function that turns a closed form into the outputs of statsEstimates() (same
+* units, one exact value each); the warm-up and run length are empty
+* - Input: *t (closed form of the point)
+*           *p (inputs of the point)
+* - Output: est (outputs)
+*******************************************************************************/
+void theoryEstimates(const Theory *t, const Params *p, Estimate est[])
+{
+    double value[EST_IDLE] = {
+        t->throughput / TIME_UNIT, 100.0 * t->allBusy, t->customers, t->sojourn * TIME_UNIT,
+        100.0 * t->busy, 100.0 * t->blocking, 100.0 * t->waiting, t->response[0] * TIME_UNIT,
+        t->response[1] * TIME_UNIT, t->response[2] * TIME_UNIT, NAN, NAN };
+
+    for (int k = 0; k < EST_IDLE + p->coreEdges.n + 1; k++)
+    {
+        double x = (k < EST_IDLE) ? value[k]
+                 : (k < EST_IDLE + p->coreEdges.n) ? theoryIdleBelow(t, p->coreEdges.at[k - EST_IDLE])
+                 : theoryIdleBelow(t, INFINITY);
+        estInit(&est[k]);
+        if (!isnan(x))
+            estAdd(&est[k], x);
+    }
+}
+
+/*******************************************************************************
+*       validatePoint(const Params *p, Stats stats[], int reps, Record *rec)
+********************************************************************************
+* Function that compares the main outputs of a simulated point with its closed
+* form. An output deviates if it differs from theory by more than
+* VALIDATE_TOLERANCE and, with replications, by more than its CI half width.
+* The comparison is printed as a table, or appended to the record of the
+* point (name_theory and name_dev, the deviation in %).
+* - Input: *p (inputs of the point)
+*           stats (outputs of each replication of the point)
+*           reps (number of replications)
+*           *rec (record to append to, NULL to print)
+* - Output: int (number of outputs that deviate, -1 if there is no closed form)
+*******************************************************************************/
+int validatePoint(const Params *p, Stats stats[], int reps, Record *rec)
+{
+    Estimate sim[EST_IDLE + MAX_EDGES + 1], th[EST_IDLE + MAX_EDGES + 1];
+    Theory t;
+    bool known = theoryPoint(p, &t);
+    int deviations = 0;
+    char name[FIELD_NAME];
+
+    statsEstimates(stats, reps, sim);
+    if (known)
+        theoryEstimates(&t, p, th);
+    if (!rec)
+    {
+        printf("<-------------------------------------------------------------> \n");
+        if (!known)
+        {
+            printf("-  VALIDATION: no closed form for this point (unstable, policy other than random, replay, -A, -G, -L, -K or -F) \n");
+            return -1;
+        }
+        printf("-  VALIDATION (simulated vs closed form, tolerance %.0f%%): \n", 100.0 * VALIDATE_TOLERANCE);
+    }
+    for (int k = 0; k < EST_WARMUP; k++)
+    {
+        double value = sim[k].mean, theory = known ? th[k].mean : NAN;
+        double diff = fabs(value - theory);
+        double dev = (theory != 0) ? 100.0 * (value - theory) / theory : (value == 0 ? 0.0 : INFINITY);
+        bool bad = known && diff > VALIDATE_TOLERANCE * fabs(theory) && (reps < 2 || diff > estHalfWidth(&sim[k]));
+
+        deviations += bad;
+        if (rec)
+        {
+            snprintf(name, sizeof(name), "%s_theory", estNames[k]);
+            recordValue(rec, name, theory);
+            snprintf(name, sizeof(name), "%s_dev", estNames[k]);
+            recordValue(rec, name, known ? dev : NAN);
+        }
+        else
+            printf("-    %-28s = %f vs %f %s (%+.2f%%)%s \n", estLabels[k], value, theory,
+                   estUnits[k], dev, bad ? " DEVIATES" : "");
+    }
+    return known ? deviations : -1;
+}
+
+/*******************************************************************************
+*       gridBegin(void *ctx, int point) / gridRun(void *ctx, int point, int rep)
+*       gridEnd(void *ctx, int point) / gridWrite(void *ctx, int point)
+********************************************************************************
+* Callbacks of the sweep: allocate the outputs of a point, run one of its
+* replications, turn them into its record once every replication is done
+* (with its comparison with theory for --validate), and write the record
+* - Input: ctx (Grid being run)
+*           point (index of the point)
+*           rep (index of the replication)
+*******************************************************************************/
+void gridBegin(void *ctx, int point)
+{
+    Grid *grid = (Grid*)ctx;
+
+    grid->stats[point] = (Stats*)malloc(grid->reps * sizeof(Stats));
+    if (!grid->stats[point]) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void gridRun(void *ctx, int point, int rep)
+{
+    Grid *grid = (Grid*)ctx;
+    simulate(&grid->params[point], rep, &grid->stats[point][rep]);
+}
+
+void gridEnd(void *ctx, int point)
+{
+    Grid *grid = (Grid*)ctx;
+    Record *rec = (Record*)malloc(sizeof(Record));
+
+    if (!rec) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    fillRecord(rec, &grid->params[point], grid->stats[point], grid->reps);
+    if (grid->validate)
+    {
+        int deviations = validatePoint(&grid->params[point], grid->stats[point], grid->reps, rec);
+        if (deviations > 0)
+            grid->deviations += deviations;
+    }
+    for (int r = 0; r < grid->reps; r++)
+        statsFree(&grid->stats[point][r]);
+    free(grid->stats[point]);
+    grid->stats[point] = NULL;
+    grid->records[point] = rec;
+}
+
+void gridWrite(void *ctx, int point)
+{
+    Grid *grid = (Grid*)ctx;
+
+    outputWrite(grid->out, grid->records[point]);
+    free(grid->records[point]);
+    grid->records[point] = NULL;
+}
+
+/*******************************************************************************
+*       gridPoint(const Config *cfg, int i, Params *p)
+********************************************************************************
+* Function that finds the inputs of the i-th combination of the values of -a,
+* -d, -c and -k (-a varies fastest)
+* - Input: *cfg (command line)
+*           i (index of the point)
+* - Output: *p (inputs of the point)
+*******************************************************************************/
+void gridPoint(const Config *cfg, int i, Params *p)
+{
+    const Axis *arr = &cfg->arr, *dep = &cfg->dep, *servers = &cfg->servers, *cap = &cfg->cap;
+
+    *p = cfg->p;
+    p->arrTime = arr->at[i % arr->n];
+    i /= arr->n;
+    p->departTime = dep->at[i % dep->n];
+    i /= dep->n;
+    p->c = (int)servers->at[i % servers->n];
+    i /= servers->n;
+    p->k = (int)cap->at[i];
+}
+
+/*******************************************************************************
+*       sweepGrid(Config *cfg)
+********************************************************************************
+* Function that runs every combination of the values of -a, -d, -c and -k and
+* writes one record per point, in the format of -f (CSV if -f is text)
+* - Input: *cfg (command line)
+*******************************************************************************/
+void sweepGrid(Config *cfg)
+{
+    int points = cfg->arr.n * cfg->dep.n * cfg->servers.n * cfg->cap.n;
+    double *load = (double*)malloc(points * sizeof(double));
+    Output out;
+    Grid grid = { (Params*)malloc(points * sizeof(Params)), (Stats**)calloc(points, sizeof(Stats*)),
+                  (Record**)calloc(points, sizeof(Record*)), cfg->reps, &out, cfg->validate, 0 };
+    Sweep sw;
+
+    if (!load || !grid.params || !grid.stats || !grid.records) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < points; i++)
+    {
+        Params *p = &grid.params[i];
+        gridPoint(cfg, i, p);
+        load[i] = p->departTime / (p->arrTime * p->c);
+    }
+
+    outputOpen(&out, (cfg->format == FORMAT_TEXT) ? FORMAT_CSV : cfg->format, cfg->outFile);
+    sweepInit(&sw, points, cfg->reps, load);
+    sw.ctx = &grid;
+    sw.begin = gridBegin;
+    sw.run = gridRun;
+    sw.end = gridEnd;
+    sw.write = gridWrite;
+    runSweep(&sw, cfg->threads);
+
+    sweepFree(&sw);
+    free(load);
+    free(grid.params);
+    free(grid.stats);
+    free(grid.records);
+    outputClose(&out);
+    if (grid.deviations > 0) {
+        fprintf(stderr, "%d outputs deviate from their closed form by more than %.0f%%\n",
+                grid.deviations, 100.0 * VALIDATE_TOLERANCE);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*******************************************************************************
+*       theoryGrid(Config *cfg)
+********************************************************************************
+* Function that writes the closed form of every combination of the values of
+* -a, -d, -c and -k, without simulating (--analytic): one record per point
+* with the fields of a simulation (reps 0, no CI), NaN where the point has no
+* closed form, in the format of -f (CSV if -f is text)
+* - Input: *cfg (command line)
+*******************************************************************************/
+void theoryGrid(Config *cfg)
+{
+    int points = cfg->arr.n * cfg->dep.n * cfg->servers.n * cfg->cap.n;
+    Estimate est[EST_IDLE + MAX_EDGES + 1];
+    Output out;
+
+    outputOpen(&out, (cfg->format == FORMAT_TEXT) ? FORMAT_CSV : cfg->format, cfg->outFile);
+    for (int i = 0; i < points; i++)
+    {
+        Params p;
+        Theory t;
+        Record rec;
+
+        gridPoint(cfg, i, &p);
+        if (theoryPoint(&p, &t))
+            theoryEstimates(&t, &p, est);
+        else
+            for (int k = 0; k < EST_IDLE + MAX_EDGES + 1; k++)
+                estInit(&est[k]);
+        fillFields(&rec, &p, est, 0);
+        outputWrite(&out, &rec);
+    }
+    outputClose(&out);
+}
+
+/*******************************************************************************
+*       printTheory(const Params *p)
+********************************************************************************
+* Function that prints the closed form of a single point (--analytic)
+* - Input: *p (inputs of the point)
+*******************************************************************************/
+void printTheory(const Params *p)
+{
+    Estimate est[EST_IDLE + MAX_EDGES + 1];
+    Theory t;
+    char label[48];
+
+    if (!theoryPoint(p, &t)) {
+        printf("No closed form for this point (unstable, policy other than random, replay, -A, -G, -L, -K or -F)!\n");
+        exit(EXIT_FAILURE);
+    }
+    theoryEstimates(&t, p, est);
+    printf("<-------------------------------------------------------------> \n");
+    printf("-  CLOSED FORM (%s, %d server(s), load %f): \n", MODEL_CAPACITY ? "M/M/1/K"
+           : (p->c == 1) ? "M/M/1" : (MODEL_QUEUE == QUEUE_PER_SERVER) ? "random M/M/1 per server" : "M/M/c",
+           p->c, p->departTime / (p->arrTime * p->c));
+    for (int k = 0; k < EST_WARMUP; k++)
+        printf("-    %-28s = %f %s \n", estLabels[k], est[k].mean, estUnits[k]);
+    if ((MODEL_STATS & STAT_CORE_IDLE) && est[EST_IDLE].n > 0)
+    {
+        for (int k = 0; k < p->coreEdges.n; k++)
+        {
+            edgeLabel(label, "% core idle < ", p->coreEdges.at[k]);
+            printf("-    %-28s = %f \n", label, est[EST_IDLE + k].mean);
+        }
+    }
+    printf("<-------------------------------------------------------------> \n");
+}
+
+/*******************************************************************************
+*       benchPoint(void *ctx)
+********************************************************************************
+* Workload of the benchmark: one run of a point
+* - Input: ctx (Params of the point)
+* - Output: unsigned long (events simulated: arrivals and departures)
+*******************************************************************************/
+unsigned long benchPoint(void *ctx)
+{
+    Stats st;
+    unsigned long events;
+
+    simulate((const Params*)ctx, 0, &st);
+    events = st.arrived + st.departures;
+    statsFree(&st);
+    return events;
+}
+
+/*******************************************************************************
+*       benchModel(Config *cfg)
+********************************************************************************
+* Function that benchmarks the simulator over a grid of loads and, if it has
+* -c, of servers: every point runs about cfg->bench events with the seed of
+* -S, in a child process of its own, and its record gives events/sec,
+* ns/event, peak RSS and allocations/event. With --baseline, every point is
+* compared with the same point of an earlier benchmark, and the function
+* exits with a failure if one of them is slower by more than BENCH_TOLERANCE.
+* - Input: *cfg (command line)
+*******************************************************************************/
+void benchModel(Config *cfg)
+{
+    static const double loads[] = { 0.1, 0.3, 0.5, 0.7, 0.9, 0.95, 0.99 };
+    static const int servers[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+    int numServers = strchr(cfg->optstring, 'c') ? (int)(sizeof(servers) / sizeof(servers[0])) : 1;
+    int numLoads = sizeof(loads) / sizeof(loads[0]);
+    int compared = 0, regressed = 0;
+    BenchBase *base = NULL;
+    Output out;
+
+    if (cfg->baseline)
+    {
+        base = (BenchBase*)malloc(sizeof(BenchBase));
+        if (!base) {
+            printf("Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        benchLoad(cfg->baseline, base);
+    }
+
+    outputOpen(&out, (cfg->format == FORMAT_TEXT) ? FORMAT_JSON : cfg->format, cfg->outFile);
+    for (int i = 0; i < numServers; i++)
+    {
+        for (int j = 0; j < numLoads; j++)
+        {
+            Params p = cfg->p;
+            BenchResult r;
+            Record rec;
+            double nsPerEvent, old = NAN;
+
+            // Every job is an arrival and a departure
+            p.c = servers[i];
+            p.arrTime = p.departTime / (loads[j] * p.c);
+            p.endTime = 0.5 * cfg->bench * p.arrTime;
+            p.warmup = false;
+            p.precision = 0.0;
+            p.traceFile = NULL;
+            p.replayFile = NULL;
+            p.ckptFile = NULL;
+            p.resume = false;
+
+            benchMeasure(benchPoint, &p, &r);
+            nsPerEvent = 1e9 * r.seconds / r.events;
+            if (base)
+                old = benchFind(base, MODEL_NAME, loads[j], p.c);
+            if (!isnan(old))
+            {
+                compared++;
+                if (nsPerEvent > (1.0 + BENCH_TOLERANCE) * old) {
+                    regressed++;
+                    fprintf(stderr, "Regression: %s load %g servers %d: %.1f ns/event (was %.1f)\n",
+                            MODEL_NAME, loads[j], p.c, nsPerEvent, old);
+                }
+            }
+
+            recordInit(&rec);
+            recordText(&rec, "model", MODEL_NAME);
+            recordText(&rec, "policy", (MODEL_QUEUE == QUEUE_PER_SERVER) ? policyNames[p.policy] : "shared");
+            recordValue(&rec, "load", loads[j]);
+            recordValue(&rec, "servers", p.c);
+            recordInteger(&rec, "seed", p.seed);
+            recordValue(&rec, "events", r.events);
+            recordValue(&rec, "seconds", r.seconds);
+            recordValue(&rec, "events_per_sec", r.events / r.seconds);
+            recordValue(&rec, "ns_per_event", nsPerEvent);
+            recordValue(&rec, "peak_rss_kb", r.peakRss);
+            recordValue(&rec, "allocs", r.allocs);
+            recordValue(&rec, "alloc_bytes", r.allocBytes);
+            recordValue(&rec, "allocs_per_event", (double)r.allocs / r.events);
+            recordValue(&rec, "baseline_ns_per_event", old);
+            recordValue(&rec, "change_pct", 100.0 * (nsPerEvent / old - 1.0));
+            outputWrite(&out, &rec);
+        }
+    }
+    outputClose(&out);
+
+    if (base)
+        fprintf(stderr, "%d of %d points slower than the baseline by more than %.0f%%\n",
+                regressed, compared, 100.0 * BENCH_TOLERANCE);
+    free(base);
+    if (regressed > 0)
+        exit(EXIT_FAILURE);
+}
+
+/*******************************************************************************
+*       printWarmup(Stats *st)
+********************************************************************************
+* Function that prints the output analysis of a single run: the warm-up
+* deleted by MSER-5, the time kept, and the batch means interval of the mean
+* response time
+* - Input: *st (outputs of the run)
+*******************************************************************************/
+void printWarmup(Stats *st)
+{
+    printf("<-------------------------------------------------------------> \n");
+    printf("-  OUTPUT ANALYSIS (MSER-5 warm-up, %d batch means, %s): \n", BM_BATCHES, CI_LEVEL);
+    printf("-    Warm-up deleted              = %f sec \n", st->warmupTime * TIME_UNIT);
+    printf("-    Simulated time kept          = %f sec \n", st->time * TIME_UNIT);
+    if (st->responseMean.n < 2)
+        printf("-    Mean response time           = too few customers for batch means \n");
+    else
+        printf("-    Mean response time           = %f +/- %f sec \n",
+               st->responseMean.mean * TIME_UNIT, estHalfWidth(&st->responseMean) * TIME_UNIT);
+}
+
+/*******************************************************************************
+*       configInit(Config *cfg)
+********************************************************************************
+* Function that sets every option to the default of the model
+* - Output: *cfg (command line with default values)
+*******************************************************************************/
+void configInit(Config *cfg)
+{
+    cfg->p.endTime = SIM_TIME;
+    cfg->p.arrTime = ARR_TIME;
+    cfg->p.departTime = SERV_TIME;
+    parseDistr("exp", &cfg->p.service);
+    parseArrival("poisson", &cfg->p.arrivals);
+    cfg->p.c = NUM_SERVERS;
+    cfg->p.k = CAPACITY;
+    cfg->p.seed = RNG_SEED;
+    cfg->p.policy = POLICY_RANDOM;
+    cfg->p.d = POD_CHOICES;
+    cfg->p.warmup = false;
+    cfg->p.precision = 0.0;
+    cfg->p.traceFile = NULL;
+    cfg->p.replayFile = NULL;
+    cfg->p.replayScale = 1.0;
+    cfg->p.ckptFile = NULL;
+    cfg->p.ckptInterval = CKPT_INTERVAL;
+    cfg->p.resume = false;
+    parseEdges(CORE_EDGES, &cfg->p.coreEdges);
+    parseEdges(PKG_EDGES, &cfg->p.pkgEdges);
+    parseCStates(CSTATES, &cfg->p.cstates);
+    cfg->p.idlePolicy = CPOLICY_OFF;
+    cfg->p.idleState = 0;
+    parseCStates(PKG_CSTATES, &cfg->p.pkgCStates);
+    cfg->p.pkgPolicy = CPOLICY_OFF;
+    cfg->p.pkgLimit = 0;
+    parsePStates(PSTATES, &cfg->p.pstates);
+    parseGovernor("off", &cfg->p.pstates, PSTATE_WINDOW, &cfg->p.governor);
+    cfg->arr = (Axis){ 1, { ARR_TIME } };
+    cfg->dep = (Axis){ 1, { SERV_TIME } };
+    cfg->servers = (Axis){ 1, { NUM_SERVERS } };
+    cfg->cap = (Axis){ 1, { CAPACITY } };
+    cfg->reps = 1;
+    cfg->threads = defaultThreads();
+    cfg->format = FORMAT_TEXT;
+    cfg->outFile = NULL;
+    cfg->optstring = "";
+    cfg->bench = 0;
+    cfg->baseline = NULL;
+    cfg->analytic = false;
+    cfg->validate = false;
+}
+
+/*******************************************************************************
+*       parseOptions(int argc, char **argv, const char *optstring, Config *cfg)
+********************************************************************************
+* Function that parses the options of a simulator. Every simulator accepts a
+* subset of the same options, listed in optstring (getopt() syntax), and
+* --resume, --bench[=events], --baseline file, --analytic and --validate.
+* - Input: argc, argv (command line)
+*           optstring (options accepted by the simulator)
+* - Output: *cfg (parsed command line)
+*           bool (false if an option is unknown or malformed)
+*******************************************************************************/
+bool parseOptions(int argc, char **argv, const char *optstring, Config *cfg)
+{
+    int opt;    // Hold the options passed as argument
+    const char *idlePolicy = "off";     // Resolved once the table (-T) is known
+    const char *pkgPolicy = "off";      // Resolved once the table (-U) is known
+    const char *governor = "off";       // Resolved once the table (-V) is known
+    static const struct option longOptions[] = {
+        { "resume", no_argument, NULL, OPT_RESUME },
+        { "bench", optional_argument, NULL, OPT_BENCH },
+        { "baseline", required_argument, NULL, OPT_BASELINE },
+        { "analytic", no_argument, NULL, OPT_ANALYTIC },
+        { "validate", no_argument, NULL, OPT_VALIDATE },
+        { NULL, 0, NULL, 0 } };
+
+    cfg->optstring = optstring;
+
+    while ( (opt = getopt_long(argc, argv, optstring, longOptions, NULL)) != -1 )
+    {
+        switch (opt) {
+            case 'a':
+                if (!parseAxis(optarg, &cfg->arr))
+                    return false;
+                break;
+            case 'd':
+                if (!parseAxis(optarg, &cfg->dep))
+                    return false;
+                break;
+            case 'c':
+                if (!parseAxis(optarg, &cfg->servers))
+                    return false;
+                break;
+            case 'k':
+                if (!parseAxis(optarg, &cfg->cap))
+                    return false;
+                break;
+            case 's':
+                cfg->p.endTime = atof(optarg);
+                break;
+            case 'b':
+                if (!parseEdges(optarg, &cfg->p.coreEdges))
+                    return false;
+                break;
+            case 'p':
+                if (!parseEdges(optarg, &cfg->p.pkgEdges))
+                    return false;
+                break;
+            case 'A':
+                if (!parseArrival(optarg, &cfg->p.arrivals))
+                    return false;
+                break;
+            case 'G':
+                if (!parseDistr(optarg, &cfg->p.service))
+                    return false;
+                break;
+            case 'P':
+                if (!parsePolicy(optarg, &cfg->p.policy))
+                    return false;
+                break;
+            case 'D':
+                cfg->p.d = atoi(optarg);
+                break;
+            case 'L':
+                idlePolicy = optarg;
+                break;
+            case 'T':
+                if (!parseCStates(optarg, &cfg->p.cstates))
+                    return false;
+                break;
+            case 'K':
+                pkgPolicy = optarg;
+                break;
+            case 'U':
+                if (!parseCStates(optarg, &cfg->p.pkgCStates))
+                    return false;
+                break;
+            case 'F':
+                governor = optarg;
+                break;
+            case 'V':
+                if (!parsePStates(optarg, &cfg->p.pstates))
+                    return false;
+                break;
+            case 'w':
+                cfg->p.warmup = true;
+                break;
+            case 'e':
+                cfg->p.precision = atof(optarg);
+                cfg->p.warmup = true;
+                if (cfg->p.precision <= 0)
+                    return false;
+                break;
+            case 't':
+                cfg->p.traceFile = optarg;
+                break;
+            case 'r':
+                cfg->p.replayFile = optarg;
+                break;
+            case 'x':
+                cfg->p.replayScale = atof(optarg);
+                if (cfg->p.replayScale <= 0)
+                    return false;
+                break;
+            case 'C':
+                cfg->p.ckptFile = optarg;
+                break;
+            case 'I':
+                cfg->p.ckptInterval = atof(optarg);
+                break;
+            case OPT_RESUME:
+                cfg->p.resume = true;
+                break;
+            case OPT_BENCH:
+                cfg->bench = optarg ? strtoul(optarg, NULL, 0) : BENCH_EVENTS;
+                if (cfg->bench < 2)
+                    return false;
+                break;
+            case OPT_BASELINE:
+                cfg->baseline = optarg;
+                break;
+            case OPT_ANALYTIC:
+                cfg->analytic = true;
+                break;
+            case OPT_VALIDATE:
+                cfg->validate = true;
+                break;
+            case 'S':
+                cfg->p.seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'R':
+                cfg->reps = atoi(optarg);
+                break;
+            case 'j':
+                cfg->threads = atoi(optarg);
+                break;
+            case 'f':
+                if (!parseFormat(optarg, &cfg->format))
+                    return false;
+                break;
+            case 'o':
+                cfg->outFile = optarg;
+                break;
+            default:    // '?' unknown option
+                return false;
+        }
+    }
+    if (cfg->p.d < 1)
+        return false;
+    if (!parseIdlePolicy(idlePolicy, &cfg->p.cstates, &cfg->p.idlePolicy, &cfg->p.idleState))
+        return false;
+    if (!parsePkgPolicy(pkgPolicy, &cfg->p.pkgCStates, &cfg->p.pkgPolicy, &cfg->p.pkgLimit))
+        return false;
+    if (!parseGovernor(governor, &cfg->p.pstates, PSTATE_WINDOW, &cfg->p.governor))
+        return false;
+    if ((cfg->p.traceFile || cfg->p.ckptFile) && cfg->arr.n * cfg->dep.n * cfg->servers.n * cfg->cap.n > 1)
+        return false;   // A trace or a checkpoint records a single point
+    if (cfg->p.resume && !cfg->p.ckptFile)
+        return false;
+    if (cfg->baseline && !cfg->bench)
+        return false;
+    if (cfg->analytic && cfg->validate)
+        return false;
+    if (cfg->p.traceFile && cfg->p.ckptFile)
+        return false;   // A resumed trace would miss the events before the checkpoint
+    if (!axisAbove(&cfg->arr, 0, false) || !axisAbove(&cfg->dep, 0, false))
+        return false;   // Times must be positive
+    if (!(cfg->p.endTime > 0) || !(cfg->p.ckptInterval > 0))
+        return false;   // ... so must the length of the run and the checkpoint interval
+    if (cfg->threads < 1)
+        return false;
+    if (!axisAbove(&cfg->servers, 0, true) || !axisAbove(&cfg->cap, -1, true))
+        return false;   // At least one server, no negative capacity
+    if (MODEL_SERVERS > 0 && (cfg->servers.n > 1 || cfg->servers.at[0] != MODEL_SERVERS))
+        return false;   // The servers are fixed at compile time
+    if (cfg->p.replayFile && (cfg->p.service.type != DISTR_EXP || cfg->p.arrivals.type != ARRIVAL_POISSON))
+        return false;   // The log sets the arrival and service times
+    if (cfg->p.replayFile)
+    {
+        // The log sets the arrivals and services: report its means
+        if (cfg->arr.n > 1 || cfg->dep.n > 1)
+            return false;
+        if (!replayMeans(cfg->p.replayFile, cfg->p.replayScale, TIME_UNIT, &cfg->arr.at[0], &cfg->dep.at[0])) {
+            printf("%s has less than two jobs!\n", cfg->p.replayFile);
+            exit(EXIT_FAILURE);
+        }
+    }
+    cfg->p.arrTime = cfg->arr.at[0];
+    cfg->p.departTime = cfg->dep.at[0];
+    cfg->p.c = (int)cfg->servers.at[0];
+    cfg->p.k = (int)cfg->cap.at[0];
+    return cfg->reps >= 1;
+}
+
+/*******************************************************************************
+*       printPackage(const Params *p, const Stats *st)
+********************************************************************************
+* Function that prints the idle states of the package and its power: the
+* uncore power of its states and the power of its cores (see corePower())
+* - Input: *p (inputs of the point)
+*           *st (outputs, merged over every replication)
+*******************************************************************************/
+void printPackage(const Params *p, const Stats *st)
+{
+    double uncore = cstatePower(&p->pkgCStates, &st->pkgCStates, 0, st->time);
+    double cores = p->c * corePower(p, st);
+
+    printCStates("PACKAGE", &p->pkgCStates, pkgPolicyName(p), &st->pkgCStates, st->time,
+                 st->departures, TIME_UNIT);
+    printCStateEnergy(&p->pkgCStates, &st->pkgCStates, st->time, TIME_UNIT);
+    printf("-    Package power                = %f W (uncore %f W + cores %f W) \n",
+           uncore + cores, uncore, cores);
+}
+
+/*******************************************************************************
+*       runModel(Config *cfg, ReportFunc report)
+********************************************************************************
+* Function that runs the simulation requested on the command line: the
+* benchmark (--bench), the closed forms (--analytic), a sweep when a
+* parameter has several values or the results are machine-readable (-f, -o),
+* else the replications of a single point followed by the report of the model
+* (and its comparison with theory for --validate)
+* - Input: *cfg (parsed command line)
+*           report (function printing the report of the model)
+*******************************************************************************/
+void runModel(Config *cfg, ReportFunc report)
+{
+    int reps = cfg->reps;
+
+    if (cfg->bench)
+    {
+        benchModel(cfg);
+        return;
+    }
+    if (cfg->analytic)
+    {
+        if (cfg->arr.n * cfg->dep.n * cfg->servers.n * cfg->cap.n > 1 || cfg->outFile != NULL || cfg->format != FORMAT_TEXT)
+            theoryGrid(cfg);
+        else
+            printTheory(&cfg->p);
+        return;
+    }
+    if (cfg->arr.n * cfg->dep.n * cfg->servers.n * cfg->cap.n > 1 || cfg->outFile != NULL || cfg->format != FORMAT_TEXT)
+    {
+        sweepGrid(cfg);
+        return;
+    }
+
+    Stats *stats = (Stats*)malloc(reps * sizeof(Stats));
+    Stats *total = (Stats*)malloc(sizeof(Stats));
+    if (!stats || !total) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    Run run = { &cfg->p, stats };
+
+    runReplications(runOne, &run, reps, cfg->threads);
+
+    // Merge the replications in order, so the output does not depend on -j
+    statsInit(total, &cfg->p);
+    for (int r = 0; r < reps; r++)
+        statsMerge(total, &stats[r]);
+
+    report(&cfg->p, (reps == 1) ? &stats[0] : total);
+    if (MODEL_POWER && cfg->p.idlePolicy != CPOLICY_OFF)
+    {
+        printCStates("CORE", &cfg->p.cstates, idlePolicyName(&cfg->p), &total->cstates, total->time,
+                     total->departures, TIME_UNIT);
+        if (cfg->p.governor.type == GOV_OFF)    // Else busy at the frequencies, below
+            printCStateEnergy(&cfg->p.cstates, &total->cstates, total->time, TIME_UNIT);
+    }
+    if (MODEL_POWER && cfg->p.governor.type != GOV_OFF)
+    {
+        printPStates(&cfg->p.pstates, cfg->p.governor.name, &total->pstates, total->time,
+                     cfg->p.c, TIME_UNIT);
+        printf("-    Power of the cores           = %f W (%f W per core) \n",
+               cfg->p.c * corePower(&cfg->p, total), corePower(&cfg->p, total));
+    }
+    if (MODEL_POWER && cfg->p.pkgPolicy != CPOLICY_OFF)
+        printPackage(&cfg->p, total);
+    if (reps == 1 && cfg->p.warmup)
+        printWarmup(&stats[0]);
+    if (reps > 1)
+        printCI(stats, reps);
+#ifdef PROBES
+    printProbes(&total->probes);
+#endif
+    int deviations = cfg->validate ? validatePoint(&cfg->p, stats, reps, NULL) : 0;
+    printf("<-------------------------------------------------------------> \n");
+
+    for (int r = 0; r < reps; r++)
+        statsFree(&stats[r]);
+    statsFree(total);
+    free(stats);
+    free(total);
+    if (deviations > 0)
+        exit(EXIT_FAILURE);
+}
+
+#endif
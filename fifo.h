@@ -0,0 +1,114 @@
+/*******************************************************************************
+*                            Ring-buffer Job Queues
+********************************************************************************
+* Notes: FIFO of queued jobs (their arrival time) with O(1) push and pop. Jobs
+* are stored in a power-of-two ring that doubles when full, so a queue only
+* allocates when it reaches a new maximum depth instead of once per job.
+*******************************************************************************/
+#ifndef FIFO_H
+#define FIFO_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for realloc() and exit()
+#include "probe.h"              // Needed for probeCount()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define FIFO_MIN_CAP   16       // Capacity allocated on the first push
+
+typedef struct Fifo {
+    double *items;              // Ring of queued values
+    unsigned int head;          // Index of the oldest value
+    unsigned int count;         // Number of queued values
+    unsigned int mask;          // Capacity - 1 (capacity is a power of two)
+} Fifo;
+
+/*******************************************************************************
+*       fifoInit(Fifo *q)
+********************************************************************************
+* Function that initializes an empty queue (no memory is allocated until the
+* first push)
+* - Input: *q (queue to initialize)
+*******************************************************************************/
+void fifoInit(Fifo *q)
+{
+    q->items = NULL;
+    q->head = 0;
+    q->count = 0;
+    q->mask = 0;
+}
+
+/*******************************************************************************
+*       fifoGrow(Fifo *q)
+********************************************************************************
+* Function that doubles the capacity of a full queue, unwrapping its content at
+* the beginning of the new ring
+* - Input: *q (queue to grow)
+*******************************************************************************/
+void fifoGrow(Fifo *q)
+{
+    unsigned int cap = (q->items == NULL) ? 0 : q->mask + 1;
+    unsigned int newCap = (cap == 0) ? FIFO_MIN_CAP : 2 * cap;
+    double *items = (double*)realloc(q->items, newCap * sizeof(double));
+
+    if (!items) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    // The wrapped part [0, head) now follows the tail of the old ring
+    for (unsigned int i = 0; i < q->head; i++)
+        items[cap + i] = items[i];
+    q->items = items;
+    q->mask = newCap - 1;
+}
+
+/*******************************************************************************
+*       fifoPush(Fifo *q, double value)
+********************************************************************************
+* Function that appends a value at the tail of the queue
+* - Input: *q (queue to append to)
+*           value (value to queue)
+*******************************************************************************/
+void fifoPush(Fifo *q, double value)
+{
+    probeCount(PROBE_FIFO_PUSH);
+    if (q->items == NULL || q->count == q->mask + 1)
+        fifoGrow(q);
+    q->items[(q->head + q->count) & q->mask] = value;
+    q->count++;
+}
+
+/*******************************************************************************
+*       fifoPop(Fifo *q)
+********************************************************************************
+* Function that removes the value at the head of the queue
+* - Input: *q (queue to remove from)
+* - Output: double (oldest value, -1 if the queue is empty)
+*******************************************************************************/
+double fifoPop(Fifo *q)
+{
+    double value;
+
+    probeCount(PROBE_FIFO_POP);
+    if (q->count == 0)
+        return -1;
+    value = q->items[q->head];
+    q->head = (q->head + 1) & q->mask;
+    q->count--;
+    return value;
+}
+
+/*******************************************************************************
+*       fifoFree(Fifo *q)
+********************************************************************************
+* Function that releases the memory of the queue
+* - Input: *q (queue to release)
+*******************************************************************************/
+void fifoFree(Fifo *q)
+{
+    free(q->items);
+    fifoInit(q);
+}
+
+#endif
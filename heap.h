@@ -0,0 +1,172 @@
+/*******************************************************************************
+*                      Indexed Min-Heap of Departure Times
+********************************************************************************
+* Notes: 4-ary min-heap over the departure time of every server. The heap keeps
+* the position of each server, so the departure of a server can be moved in
+* either direction in O(log c) and the next departing server is read in O(1),
+* instead of scanning the c departure times after every event.
+* The departure times themselves stay in the caller's array (custDepartures),
+* which heapUpdate() keeps up to date.
+*******************************************************************************/
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for malloc() and exit()
+#include "probe.h"              // Needed for probeCount()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define HEAP_ARITY     4        // Children per node
+
+typedef struct DepHeap {
+    double *key;                // Departure time of each server (not owned)
+    int *heap;                  // heap[i] = server stored at position i
+    int *pos;                   // pos[s] = position of server s in heap[]
+    int size;                   // Number of servers
+} DepHeap;
+
+/*******************************************************************************
+*       heapSiftUp(DepHeap *h, int i)
+********************************************************************************
+* Function that moves the server at position i towards the root while its
+* departure is earlier than its parent's
+* - Input: *h (heap to update)
+*           i (position of the server)
+*******************************************************************************/
+void heapSiftUp(DepHeap *h, int i)
+{
+    int server = h->heap[i];
+    double key = h->key[server];
+
+    while (i > 0)
+    {
+        int parent = (i - 1) / HEAP_ARITY;
+        if (h->key[h->heap[parent]] <= key)
+            break;
+        h->heap[i] = h->heap[parent];
+        h->pos[h->heap[i]] = i;
+        i = parent;
+        probeCount(PROBE_HEAP_MOVE);
+    }
+    h->heap[i] = server;
+    h->pos[server] = i;
+}
+
+/*******************************************************************************
+*       heapSiftDown(DepHeap *h, int i)
+********************************************************************************
+* Function that moves the server at position i towards the leaves while one of
+* its children departs earlier
+* - Input: *h (heap to update)
+*           i (position of the server)
+*******************************************************************************/
+void heapSiftDown(DepHeap *h, int i)
+{
+    int server = h->heap[i];
+    double key = h->key[server];
+
+    for (;;)
+    {
+        int first = HEAP_ARITY * i + 1;
+        int last = first + HEAP_ARITY;
+        int best = -1;
+        double bestKey = key;
+
+        if (last > h->size)
+            last = h->size;
+        for (int child = first; child < last; child++)
+        {
+            if (h->key[h->heap[child]] < bestKey)
+            {
+                best = child;
+                bestKey = h->key[h->heap[child]];
+            }
+        }
+        if (best == -1)
+            break;
+        h->heap[i] = h->heap[best];
+        h->pos[h->heap[i]] = i;
+        i = best;
+        probeCount(PROBE_HEAP_MOVE);
+    }
+    h->heap[i] = server;
+    h->pos[server] = i;
+}
+
+/*******************************************************************************
+*       heapInit(DepHeap *h, double key[], int c)
+********************************************************************************
+* Function that builds the heap over the departure times of c servers
+* - Input: *h (heap to initialize)
+*           key (departure time of each server, must outlive the heap)
+*           c (number of servers)
+*******************************************************************************/
+void heapInit(DepHeap *h, double key[], int c)
+{
+    h->key = key;
+    h->size = c;
+    h->heap = (int*)malloc(c * sizeof(int));
+    h->pos = (int*)malloc(c * sizeof(int));
+    if (!h->heap || !h->pos) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < c; i++)
+    {
+        h->heap[i] = i;
+        h->pos[i] = i;
+    }
+    for (int i = (c - 2) / HEAP_ARITY; i >= 0; i--)
+        heapSiftDown(h, i);
+}
+
+/*******************************************************************************
+*       heapUpdate(DepHeap *h, int server, double key)
+********************************************************************************
+* Function that sets the departure time of a server and restores the heap
+* (decrease-key or increase-key)
+* - Input: *h (heap to update)
+*           server (index of the server)
+*           key (new departure time)
+*******************************************************************************/
+void heapUpdate(DepHeap *h, int server, double key)
+{
+    double old = h->key[server];
+
+    probeCount(PROBE_HEAP_UPDATE);
+    h->key[server] = key;
+    if (key < old)
+        heapSiftUp(h, h->pos[server]);
+    else if (key > old)
+        heapSiftDown(h, h->pos[server]);
+}
+
+/*******************************************************************************
+*       heapMin(DepHeap *h)
+********************************************************************************
+* Function that returns the server with the earliest departure time
+* - Input: *h (heap to query)
+* - Output: int (index of the server)
+*******************************************************************************/
+int heapMin(DepHeap *h)
+{
+    return h->heap[0];
+}
+
+/*******************************************************************************
+*       heapFree(DepHeap *h)
+********************************************************************************
+* Function that releases the memory of the heap
+* - Input: *h (heap to release)
+*******************************************************************************/
+void heapFree(DepHeap *h)
+{
+    free(h->heap);
+    free(h->pos);
+    h->heap = NULL;
+    h->pos = NULL;
+}
+
+#endif
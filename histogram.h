@@ -0,0 +1,306 @@
+/*******************************************************************************
+*                  Streaming Histograms and Quantile Sketches
+********************************************************************************
+* Notes: Constant-memory replacements for "keep every period in a list and walk
+* it after the run". Two accumulators are provided, both updated in O(1) at
+* the moment a period closes:
+*   - Histogram: log-linear (HDR-style) histogram. Each power of two is split
+*     in HIST_SUB linear sub-buckets, so any value between 2^HIST_MIN_EXP and
+*     2^HIST_MAX_EXP lands in a bucket whose width is at most 1/HIST_SUB of
+*     the value. Every bucket keeps the number of values and their sum, which
+*     makes it both a distribution (time-weighted CDF) and a mergeable
+*     quantile sketch with a relative error below 1/(2*HIST_SUB).
+*   - EdgeDistr: exact sum of the values below a set of configurable edges
+*     (e.g. the 2/20/600us core idle thresholds).
+*******************************************************************************/
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for strtod()
+#include <string.h>             // Needed for memcpy() and memset()
+#include <stdint.h>             // Needed for uint64_t
+#include <stdbool.h>            // Needed for bool type
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define HIST_SUB_BITS  4        // log2 of sub-buckets per power of two
+#define HIST_SUB       (1 << HIST_SUB_BITS)
+#define HIST_MIN_EXP   (-30)    // Smallest tracked value 2^-30 (~1e-9)
+#define HIST_MAX_EXP   40       // Largest tracked value 2^40 (~1e12)
+#define HIST_BUCKETS   ((HIST_MAX_EXP - HIST_MIN_EXP) * HIST_SUB)
+// Bucket key of the smallest tracked value: biased exponent and the top
+// HIST_SUB_BITS bits of the mantissa of an IEEE-754 double
+#define HIST_KEY_MIN   ((int64_t)(1023 + HIST_MIN_EXP) << HIST_SUB_BITS)
+
+#define MAX_EDGES      16       // Maximum number of configurable edges
+
+typedef struct Histogram {      // Log-linear histogram of positive values
+    unsigned long counts[HIST_BUCKETS];  // Number of values per bucket
+    double sums[HIST_BUCKETS];           // Sum of values per bucket
+    unsigned long count;        // Total number of values
+    double total;               // Sum of all values
+    double min;
+    double max;
+} Histogram;
+
+typedef struct Edges {          // Sorted list of distribution edges
+    int n;
+    double at[MAX_EDGES];
+} Edges;
+
+typedef struct EdgeDistr {      // Sum of the values below each edge
+    const Edges *edges;
+    double below[MAX_EDGES];
+    double total;               // Sum of all values
+} EdgeDistr;
+
+/*******************************************************************************
+*       histInit(Histogram *h)
+********************************************************************************
+* Function that initializes an empty histogram
+* - Input: *h (histogram to initialize)
+*******************************************************************************/
+void histInit(Histogram *h)
+{
+    memset(h, 0, sizeof(Histogram));
+}
+
+/*******************************************************************************
+*       histBucket(double value)
+********************************************************************************
+* Function that returns the bucket of a value. Values outside of the tracked
+* range are clamped into the first or last bucket.
+* - Input: value (value to look up)
+* - Output: int (index of the bucket)
+*******************************************************************************/
+int histBucket(double value)
+{
+    uint64_t bits;
+    int64_t key;
+
+    if (!(value > 0))
+        return 0;
+    memcpy(&bits, &value, sizeof(bits));
+    key = (int64_t)(bits >> (52 - HIST_SUB_BITS)) - HIST_KEY_MIN;
+    if (key < 0)
+        return 0;
+    if (key >= HIST_BUCKETS)
+        return HIST_BUCKETS - 1;
+    return (int)key;
+}
+
+/*******************************************************************************
+*       histLower(int bucket)
+********************************************************************************
+* Function that returns the lower edge of a bucket (the upper edge of bucket b
+* is histLower(b + 1))
+* - Input: bucket (index of the bucket)
+* - Output: double (smallest value stored in the bucket)
+*******************************************************************************/
+double histLower(int bucket)
+{
+    uint64_t bits = (uint64_t)(bucket + HIST_KEY_MIN) << (52 - HIST_SUB_BITS);
+    double value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*******************************************************************************
+*       histAdd(Histogram *h, double value)
+********************************************************************************
+* Function that records a value in the histogram
+* - Input: *h (histogram to update)
+*           value (value to record)
+*******************************************************************************/
+void histAdd(Histogram *h, double value)
+{
+    int b = histBucket(value);
+
+    h->counts[b]++;
+    h->sums[b] += value;
+    if (h->count == 0 || value < h->min)
+        h->min = value;
+    if (h->count == 0 || value > h->max)
+        h->max = value;
+    h->count++;
+    h->total += value;
+}
+
+/*******************************************************************************
+*       histMerge(Histogram *dst, const Histogram *src)
+********************************************************************************
+* Function that adds the content of a histogram into another one
+* - Input: *dst (histogram to update)
+*           *src (histogram to add)
+*******************************************************************************/
+void histMerge(Histogram *dst, const Histogram *src)
+{
+    if (src->count == 0)
+        return;
+    for (int b = 0; b < HIST_BUCKETS; b++)
+    {
+        dst->counts[b] += src->counts[b];
+        dst->sums[b] += src->sums[b];
+    }
+    if (dst->count == 0 || src->min < dst->min)
+        dst->min = src->min;
+    if (dst->count == 0 || src->max > dst->max)
+        dst->max = src->max;
+    dst->count += src->count;
+    dst->total += src->total;
+}
+
+/*******************************************************************************
+*       histQuantile(const Histogram *h, double q)
+********************************************************************************
+* Function that estimates a quantile of the recorded values, interpolating
+* linearly inside the bucket that holds the requested rank
+* - Input: *h (histogram to query)
+*           q (quantile, between 0 and 1)
+* - Output: double (estimated value, 0 if the histogram is empty)
+*******************************************************************************/
+double histQuantile(const Histogram *h, double q)
+{
+    double rank = q * h->count;
+    unsigned long seen = 0;
+
+    if (h->count == 0)
+        return 0;
+    for (int b = 0; b < HIST_BUCKETS; b++)
+    {
+        seen += h->counts[b];
+        if (h->counts[b] != 0 && seen >= rank)
+        {
+            double lower = histLower(b);
+            double below = rank - (seen - h->counts[b]);   // Rank inside the bucket
+            double value = lower + (histLower(b + 1) - lower) * below / h->counts[b];
+            if (value < h->min)
+                value = h->min;
+            if (value > h->max)
+                value = h->max;
+            return value;
+        }
+    }
+    return h->max;
+}
+
+/*******************************************************************************
+*       parseEdges(const char *arg, Edges *edges)
+********************************************************************************
+* Function that parses a comma separated list of increasing edges
+* - Input: *arg (list of edges, e.g. "2,20,600")
+*           *edges (parsed edges)
+* - Output: bool (false if the list is malformed)
+*******************************************************************************/
+bool parseEdges(const char *arg, Edges *edges)
+{
+    char *end;
+
+    edges->n = 0;
+    while (*arg != '\0')
+    {
+        if (edges->n == MAX_EDGES)
+            return false;
+        edges->at[edges->n] = strtod(arg, &end);
+        if (end == arg || (*end != ',' && *end != '\0'))
+            return false;
+        if (edges->n > 0 && edges->at[edges->n] <= edges->at[edges->n - 1])
+            return false;
+        edges->n++;
+        arg = (*end == ',') ? end + 1 : end;
+    }
+    return edges->n > 0;
+}
+
+/*******************************************************************************
+*       edgeInit(EdgeDistr *d, const Edges *edges)
+********************************************************************************
+* Function that initializes an empty edge distribution
+* - Input: *d (distribution to initialize)
+*           *edges (edges of the distribution, must outlive it)
+*******************************************************************************/
+void edgeInit(EdgeDistr *d, const Edges *edges)
+{
+    memset(d, 0, sizeof(EdgeDistr));
+    d->edges = edges;
+}
+
+/*******************************************************************************
+*       edgeAdd(EdgeDistr *d, double value)
+********************************************************************************
+* Function that records a value in the edge distribution
+* - Input: *d (distribution to update)
+*           value (value to record)
+*******************************************************************************/
+void edgeAdd(EdgeDistr *d, double value)
+{
+    for (int k = d->edges->n - 1; k >= 0 && value < d->edges->at[k]; k--)
+        d->below[k] += value;
+    d->total += value;
+}
+
+/*******************************************************************************
+*       edgeMerge(EdgeDistr *dst, const EdgeDistr *src)
+********************************************************************************
+* Function that adds an edge distribution into another one with the same edges
+* - Input: *dst (distribution to update)
+*           *src (distribution to add)
+*******************************************************************************/
+void edgeMerge(EdgeDistr *dst, const EdgeDistr *src)
+{
+    for (int k = 0; k < dst->edges->n; k++)
+        dst->below[k] += src->below[k];
+    dst->total += src->total;
+}
+
+/*******************************************************************************
+*       printPercentiles(const char *label, const Histogram *h, double scale,
+*                        const char *unit)
+********************************************************************************
+* Function that prints the p50, p99 and p99.9 of the recorded values on one
+* line of a report
+* - Input: label (name of the metric)
+*           *h (histogram of the metric)
+*           scale (factor applied to the values, e.g. to change their unit)
+*           unit (unit of the scaled values)
+*******************************************************************************/
+void printPercentiles(const char *label, const Histogram *h, double scale, const char *unit)
+{
+    printf("-    %-29s= %f / %f / %f %s \n", label, scale * histQuantile(h, 0.50),
+           scale * histQuantile(h, 0.99), scale * histQuantile(h, 0.999), unit);
+}
+
+/*******************************************************************************
+*       printDistr(const Histogram *h)
+********************************************************************************
+* Print the cumulative distribution of the recorded time: the first row holds
+* the upper edge of every bucket between the smallest and the largest value,
+* the second one the fraction of the total recorded below that edge
+* - Input: *h (histogram to print)
+*******************************************************************************/
+void printDistr(const Histogram *h)
+{
+    int first = histBucket(h->min);
+    int last = histBucket(h->max);
+    double cumul = 0;
+
+    if (h->count == 0 || h->total == 0)
+    {
+        printf("\n\n");
+        return;
+    }
+    for (int b = first; b <= last; b++)
+        printf(b == first ? "%g" : ",%g", histLower(b + 1));
+    printf(" \n");
+    for (int b = first; b <= last; b++)
+    {
+        cumul = cumul + h->sums[b];
+        printf(b == first ? "%.4f" : ",%.4f", cumul / h->total);
+    }
+    printf(" \n");
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*******************************************************************************
+*                              Idle Server Set
+********************************************************************************
+* Notes: Set of the idle servers kept up to date as servers start and finish
+* serving. Servers are stored densely in members[] with their position in
+* pos[], so adding, removing, testing, counting and drawing a random idle
+* server are all O(1). The number of busy servers is size - count.
+*******************************************************************************/
+#ifndef IDLESET_H
+#define IDLESET_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for malloc() and exit()
+#include <stdbool.h>            // Needed for bool type
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+typedef struct IdleSet {
+    int *members;               // Idle servers in members[0, count)
+    int *pos;                   // Position of each server in members[], -1 if busy
+    int count;                  // Number of idle servers
+    int size;                   // Number of servers
+} IdleSet;
+
+/*******************************************************************************
+*       idleInit(IdleSet *set, int c)
+********************************************************************************
+* Function that initializes the set with c servers, all of them idle
+* - Input: *set (set to initialize)
+*           c (number of servers)
+*******************************************************************************/
+void idleInit(IdleSet *set, int c)
+{
+    set->members = (int*)malloc(c * sizeof(int));
+    set->pos = (int*)malloc(c * sizeof(int));
+    if (!set->members || !set->pos) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < c; i++)
+    {
+        set->members[i] = i;
+        set->pos[i] = i;
+    }
+    set->count = c;
+    set->size = c;
+}
+
+/*******************************************************************************
+*       idleHas(IdleSet *set, int server)
+********************************************************************************
+* Function that tells whether a server is idle
+* - Input: *set (set to query)
+*           server (index of the server)
+* - Output: bool (true if the server is idle)
+*******************************************************************************/
+bool idleHas(IdleSet *set, int server)
+{
+    return set->pos[server] != -1;
+}
+
+/*******************************************************************************
+*       idleAdd(IdleSet *set, int server)
+********************************************************************************
+* Function that marks a server as idle (no-op if it already is)
+* - Input: *set (set to update)
+*           server (index of the server)
+*******************************************************************************/
+void idleAdd(IdleSet *set, int server)
+{
+    if (set->pos[server] != -1)
+        return;
+    set->members[set->count] = server;
+    set->pos[server] = set->count;
+    set->count++;
+}
+
+/*******************************************************************************
+*       idleRemove(IdleSet *set, int server)
+********************************************************************************
+* Function that marks a server as busy (no-op if it already is). The last
+* member takes the place of the removed one.
+* - Input: *set (set to update)
+*           server (index of the server)
+*******************************************************************************/
+void idleRemove(IdleSet *set, int server)
+{
+    int i = set->pos[server];
+    int last;
+
+    if (i == -1)
+        return;
+    set->count--;
+    last = set->members[set->count];
+    set->members[i] = last;
+    set->pos[last] = i;
+    set->pos[server] = -1;
+}
+
+/*******************************************************************************
+*       idleAt(IdleSet *set, int i)
+********************************************************************************
+* Function that returns the i-th idle server (in no particular order), e.g. to
+* draw a random idle server with idleAt(set, r % set->count)
+* - Input: *set (set to query)
+*           i (index between 0 and set->count - 1)
+* - Output: int (index of the server)
+*******************************************************************************/
+int idleAt(IdleSet *set, int i)
+{
+    return set->members[i];
+}
+
+/*******************************************************************************
+*       idleFree(IdleSet *set)
+********************************************************************************
+* Function that releases the memory of the set
+* - Input: *set (set to release)
+*******************************************************************************/
+void idleFree(IdleSet *set)
+{
+    free(set->members);
+    free(set->pos);
+    set->members = NULL;
+    set->pos = NULL;
+}
+
+#endif
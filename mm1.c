@@ -4,7 +4,7 @@
 * Notes: UNDER CONSTRUCTION
 *------------------------------------------------------------------------------*
 * Build Command:
-* gcc -o mm1 mm1.c -lm
+* gcc -o mm1 mm1.c -lm -lpthread
 *------------------------------------------------------------------------------*
 * Execute command:
 * ./mm1
@@ -12,14 +12,6 @@
 * Author: Lucas German Wals Ochoa
 *******************************************************************************/
 
-/*******************************************************************************
-* Includes
-*******************************************************************************/
-#include <stdio.h>              // Needed for printf()
-#include <stdlib.h>             // Needed for exit() and rand()
-#include <unistd.h>             // Needed for getopts()
-#include "utils.h"              // Needed for expntl()
-
 /*******************************************************************************
 * Defined constants and variables
 * NOTE: All TIME constants are defined in seconds!
@@ -27,133 +19,60 @@
 #define SIM_TIME   1.0e9        // Simulation time
 #define ARR_TIME   90.00        // Mean time between arrivals
 #define SERV_TIME  60.00        // Mean service time
+#define CORE_EDGES "0.000002,0.000020,0.000600"  // Idle distribution edges
 
-typedef struct Node {           // Added by Georgia
-    int id;                     // This is for linked-list to store idle 
-    double value;                // period durations
-    struct Node *next;
-} Node;
+#define MODEL_QUEUE    QUEUE_SHARED
+#define MODEL_SERVERS  1
+#define MODEL_STATS    (STAT_CORE_IDLE | STAT_FULL_BUSY)
+#define TIME_UNIT      1.0
+#define MODEL_NAME     "mm1"
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for exit()
+#include "engine.h"             // Needed for simulate() and runModel()
 
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 static void show_usage(char *name);
-Node* addEntry(Node *head, int id, double value);    // added by georgia
-void freeList(Node *head);                          // added by georgia
-void printIdleDistr(Node *head, double idleTime);   // added by georgia
-void printList(Node *head);                         // added by georgia
+void printReport(const Params *p, Stats *st);
+void printIdleDistr(EdgeDistr *d, double idleTime);     // added by georgia
+void printList(SampleBuf *buf);                         // added by georgia
 
 /*******************************************************************************
 * Main Function
 *******************************************************************************/
 int main(int argc, char **argv)
 {
-    int opt;    // Hold the options passed as argument
-    double endTime = SIM_TIME;        // Total time to do Simulation
-    double arrTime = ARR_TIME;        // Mean time between arrivals
-    double departTime = SERV_TIME;    // Mean service time
+    Config cfg;     // Options of the simulation
 
-    double time = 0.0;          // Current Simulation time
-    double nextArrival = 0.0;         // Time for next arrival
-    double nextDeparture = SIM_TIME;  // Time for next departure
-    unsigned int n = 0;           // Actual number of customers in the system
+    configInit(&cfg);
+    if (!parseOptions(argc, argv, "a:A:d:s:G:b:we:t:r:x:C:I:S:R:j:f:o:", &cfg))
+        show_usage( argv[0] );
+    runModel(&cfg, printReport);
+}
 
-    unsigned int departures = 0;  // Total number of customers served
-    double busyTime = 0.0;        // Total busy time
-    double idleTime = 0.0;        // Added by georgia current idle time of the system
-    double idleTimeTotal = 0.0;   // Added by georgia total idle time 
-    double s = 0.0;               // Area of number of customers in system
-    double lastEventTime = time;  // Variable for "last event time"
-    double lastBusyTime;          // Variable for "last start of busy time"
+/*******************************************************************************
+*       printReport(const Params *p, Stats *st)
+********************************************************************************
+* Function that prints the inputs and the outputs of the simulation
+* - Input: *p (inputs of the simulation)
+*           *st (outputs, merged over every replication)
+*******************************************************************************/
+void printReport(const Params *p, Stats *st)
+{
     double x;     // Throughput rate
     double u;     // Utilization of system
     double l;     // Average number of customers in system
     double w;     // Average Sojourn time
-    Node *idlePeriods = NULL;     // Added by Georgia linked-list to save idle period duration
-    Node *arrivalPeriods = NULL;     // Added by Georgia linked-list to save interarrival times duration
-    Node *servicePeriods = NULL;     // Added by Georgia linked-list to save service time duration
-    Node *busyPeriods = NULL;     // Added by Georgia linked-list to save busy period duration
-    unsigned int idles = 0; // Added by Georgia counter of idle periods
-    unsigned int arrivals = 0; // Added by Georgia counter of arrival periods
-    unsigned int busy = 0; // Added by Georgia counter of busy periods      
-
-    if (argc > 1)
-    {     
-        while ( (opt = getopt(argc, argv, "a:d:s:")) != -1 )
-        {
-            switch (opt) {
-                case 'a':
-                    arrTime = atof(optarg);
-                    break;
-                case 'd':
-                    departTime = atof(optarg);
-                    break;
-                case 's':
-                    endTime = atof(optarg);
-                    break;
-                default:    // '?' unknown option
-                    show_usage( argv[0] );
-            }
-        }
-    }
-
-    // Simulation loop
-    while (time < endTime)
-    {
-        // Arrival occurred
-        if (nextArrival < nextDeparture)
-        {
-            time = nextArrival;
-            s = s + n * (time - lastEventTime);  // Update area under "s" curve
-            n++;    // Customers in system increase
-            lastEventTime = time;   // "last event time" for next event
-            nextArrival = time + expntl(arrTime);
-            arrivals++;
-            arrivalPeriods = addEntry(arrivalPeriods, arrivals , nextArrival - time);
-            if (n == 1) // System is full, only have 1 server
-            {
-                lastBusyTime = time;    // Set "last start of busy time"
-                nextDeparture = time + expntl(departTime); 
-                servicePeriods = addEntry(servicePeriods, departures , nextDeparture - time);
-                if (idleTime != 0) 
-                {
-                    idles++;
-                    idlePeriods = addEntry(idlePeriods, idles, time - idleTime);
-                    idleTimeTotal = idleTimeTotal + (time - idleTime);
-                    idleTime=0;
-                }
-            }
-        }
-        // Departure occurred
-        else
-        {
-            time = nextDeparture;
-            s = s + n * (time - lastEventTime); // Update area under "s" curve
-            n--;    // Customers in system decrease
-            lastEventTime = time;   // "last event time" for next event
-            departures++;           // Increment number of completions
-            if (n > 0)
-            {
-                nextDeparture = time + expntl(departTime);
-                servicePeriods = addEntry(servicePeriods, departures , nextDeparture - time);
-            }
-            else
-            {
-                nextDeparture = SIM_TIME;
-                // Update busy time sum when no customers
-                busyTime = busyTime + time - lastBusyTime;
-                // update busy period duration when no customers
-                busy++;
-                busyPeriods = addEntry(busyPeriods, busy , time - lastBusyTime);
-                idleTime = time;
-            }
-        }
-    }
 
     // Compute outputs
-    x = departures / time;  // Compute throughput rate
-    u = busyTime / time;    // Compute server utilization
-    l = s / time;           // Avg number of customers in the system
+    x = st->departures / st->time;  // Compute throughput rate
+    u = st->busyTime / st->time;    // Compute server utilization
+    l = st->s / st->time;           // Avg number of customers in the system
     w = l / x;              // Avg Sojourn time
 
     // Output results
@@ -161,32 +80,32 @@ int main(int argc, char **argv)
     printf("<            *** Results for M/M/1 simulation ***             > \n");
     printf("<-------------------------------------------------------------> \n");
     printf("-  INPUTS: \n");
-    printf("-    Total simulation time        = %.9f sec \n", endTime);
-    printf("-    Mean time between arrivals   = %.9f sec \n", arrTime);
-    printf("-    Mean service time            = %.9f sec \n", departTime);
+    printf("-    Total simulation time        = %.9f sec \n", st->warmupTime + st->time);
+    printf("-    Mean time between arrivals   = %.9f sec \n", p->arrTime);
+    if (p->arrivals.type != ARRIVAL_POISSON)
+        printf("-    Arrival process              = %s \n", p->arrivals.name);
+    printf("-    Mean service time            = %.9f sec \n", p->departTime);
+    if (p->service.type != DISTR_EXP)
+        printf("-    Service time distribution    = %s \n", p->service.name);
     printf("<-------------------------------------------------------------> \n");
     printf("-  OUTPUTS: \n");
-    printf("-    Total busy time              = %.9f sec \n", busyTime);            // added by Georgia
-    printf("-    Total idle time              = %.9f sec \n", idleTimeTotal);       // added by Georgia 
-    printf("-    # of Customers served        = %u cust \n", departures);
+    printf("-    Total busy time              = %.9f sec \n", st->busyTime);            // added by Georgia
+    printf("-    Total idle time              = %.9f sec \n", st->idleTimeAll);         // added by Georgia
+    printf("-    # of Customers served        = %lu cust \n", st->departures);
     printf("-    Throughput rate              = %f cust/sec \n", x);
     printf("-    Server utilization           = %f %% \n", 100.0 * u);
     printf("-    Avg # of cust. in system     = %f cust \n", l);
     printf("-    Mean Sojourn time            = %f sec \n", w);
+    printPercentiles("Waiting time p50/p99/p99.9", &st->waitTimes, 1.0, "sec");
+    printPercentiles("Response time p50/p99/p99.9", &st->responseTimes, 1.0, "sec");
     // printf("-    Arrival Time Periods: \n");
-    // printList(arrivalPeriods);
+    // printList(&st->arrivalPeriods);
     // printf("-    Service Time Periods: \n");
-    // printList(servicePeriods);
-    // printf("-    Busy Time Periods: \n");
-    // printList(busyPeriods);
+    // printList(&st->servicePeriods);
+    printf("-    Busy period p50/p99          = %f / %f sec \n", histQuantile(&st->fullBusyPeriods, 0.50), histQuantile(&st->fullBusyPeriods, 0.99));
     printf("-    Idle Time Periods: \n");
-    // printList(idlePeriods);
-    printIdleDistr(idlePeriods,time - busyTime);     // Added by Georgia Print Idle Distribution
-    
-    printf("<-------------------------------------------------------------> \n");
-
-    // Free memory added by Georgia
-    freeList(idlePeriods);
+    printf("-    Idle period p50/p99          = %f / %f sec \n", histQuantile(&st->coreidlePeriods, 0.50), histQuantile(&st->coreidlePeriods, 0.99));
+    printIdleDistr(&st->coreIdleDistr, st->time - st->busyTime);     // Added by Georgia Print Idle Distribution
 }
 
 /*******************************************************************************
@@ -202,102 +121,77 @@ static void show_usage(char *name)
     printf("\n");
     printf("Options: \n");
     printf("\t-a\tMean time between arrivals (in seconds) \n");
+    printf("\t-A\tProcess of the arrivals, with the mean of -a (times in its unit):\n");
+    printf("\t  \tpoisson (default), mmpp:ratio:hold, onoff:on:off, sine:amp:period\n");
+    printf("\t  \tor steps:period:m1,m2,... (rate curve repeated every period)\n");
     printf("\t-d\tMean service time (in seconds) \n");
+    printf("\t  \t-a and -d take a value, a list x1,x2,... or a range min:max:step;\n");
+    printf("\t  \tseveral values run a sweep that writes one CSV row per point\n");
+    printf("\t-G\tDistribution of the service times, with the mean of -d: exp\n");
+    printf("\t  \t(default), det, erlang:k, hyper:scv, lognormal:cv, pareto:alpha\n");
+    printf("\t  \tor weibull:shape\n");
     printf("\t-s\tTotal simulation time (in seconds) \n");
+    printf("\t-b\tEdges of the idle time distribution (in seconds, default %s) \n", CORE_EDGES);
+    printf("\t-w\tDelete the warm-up found by MSER-5 from the statistics\n");
+    printf("\t-e\tStop when the mean response time is known to this relative\n");
+    printf("\t  \tprecision, e.g. 0.01 (implies -w, -s is then the longest run)\n");
+    printf("\t-t\tRecord every event of replication 0 in this trace file\n");
+    printf("\t  \t(convert it with trace2json for Perfetto or chrome://tracing)\n");
+    printf("\t-r\tReplay a log of jobs (arrival,service in seconds, CSV or binary)\n");
+    printf("\t  \tinstead of the exponential arrivals and services (-a, -d)\n");
+    printf("\t-x\tSpeed-up of the replayed arrivals, e.g. 2 for twice the load\n");
+    printf("\t-C\tSave the state of the run to this checkpoint file, periodically\n");
+    printf("\t  \tand at the end (replication r > 0 uses <file>.r)\n");
+    printf("\t-I\tSeconds of wall-clock time between checkpoints (default %d)\n", CKPT_INTERVAL);
+    printf("\t--resume\tContinue the run saved in the checkpoint (-C), e.g. with a larger -s\n");
+    printf("\t-S\tSeed of the random streams (default %d)\n", RNG_SEED);
+    printf("\t-R\tNumber of independent replications (default 1)\n");
+    printf("\t-j\tThreads running the replications (default: # of CPUs)\n");
+    printf("\t-f\tFormat of the results: text (report), csv, json (JSON lines)\n");
+    printf("\t  \tor bin (packed doubles); same fields for every simulator\n");
+    printf("\t-o\tFile the results are written to (default: stdout)\n");
+    printf("\t--bench[=n]\tBenchmark a grid of loads, n events per point (default %d):\n", BENCH_EVENTS);
+    printf("\t  \tevents/sec, ns/event, peak RSS and allocations/event (-f json by default)\n");
+    printf("\t--baseline\tBenchmark (-f json) to compare with; fails if a point is %d%% slower\n", (int)(100 * BENCH_TOLERANCE));
+    printf("\t--analytic\tClosed form instead of a simulation (M/M/1), with\n");
+    printf("\t  \tthe fields of the results; NaN where there is none (e.g. load >= 1)\n");
+    printf("\t--validate\tCompare the simulation with its closed form; fails if an output\n");
+    printf("\t  \tdeviates by more than %d%% (and its CI)\n", (int)(100 * VALIDATE_TOLERANCE));
     exit(EXIT_SUCCESS);
 }
 
-/*********************************************************************************
-*       Node* addEntry(Node *head, int id, double value)
-**********************************************************************************
-* Function that adds a new entry to the linked-list with the idle period durations
-* (added by Georgia)
-* - Input: *head (head of linked-list)
-*           id (id of the item i want to add)
-*           value (idle time duration i want to add)
-* - Output: Node* (pointer to the new Node added to the linked-list)
-**********************************************************************************/
-
-Node* addEntry(Node *head, int id, double value) 
-{
-    Node *newNode = (Node*)malloc(sizeof(Node));
-    if (!newNode) {
-        printf("Memory allocation failed!\n");
-        return head;
-    }
-    newNode->id = id;
-    newNode->value = value;
-    newNode->next = head;
-    return newNode;
-}
-
 /*******************************************************************************
-*       freeList(Node *head)
-********************************************************************************
-* Function that deletes the allocated memory of the  linked-list of idle 
-* durations (added by Georgia)
-* - Input: *head (head of linked-list)
-*******************************************************************************/
-void freeList(Node *head) 
-{
-    Node *temp;
-    while (head) {
-        temp = head;
-        head = head->next;
-        free(temp);
-    }
-}
-
-/*******************************************************************************
-*       printList(Node *head)
+*       printList(SampleBuf *buf)
 ********************************************************************************
 * Function to print the list of idle durations (added by Georgia)
-* - Input: *head (head of linked-list)
+* - Input: *buf (buffer of samples)
 *******************************************************************************/
-void printList(Node *head) 
+void printList(SampleBuf *buf) 
 {
-    Node *temp = head;
-    while (temp) {
-        printf("ID: %d, Value: %.9f\n", temp->id, temp->value);
-        temp = temp->next;
+    unsigned long id = 0;
+    forEachSample(buf, chunk, i) {
+        printf("ID: %lu, Value: %.9f\n", ++id, chunk->values[i]);
     }
 }
 
 /*******************************************************************************
-*       printIdleDistr(Node *head, double idleTime)
+*       printIdleDistr(EdgeDistr *d, double idleTime)
 ********************************************************************************
 * Print Idle Time Distribution (added by Georgia)
-* - Input: *head (head of linked-list)
+* - Input: *d (idle time below each edge)
 *           idleTime (overall idle time of the simulation)
 *******************************************************************************/
-void printIdleDistr(Node *head, double idleTime)
+void printIdleDistr(EdgeDistr *d, double idleTime)
 {
-    double distribution[4];
-    distribution[0] = 0;
-    distribution[1] = 0;
-    distribution[2] = 0;
-    distribution[3] = 0;
+    char label[32];
 
-    struct Node *node=NULL, *temp = NULL;
-    node = head;
-    temp = head;
-    while (temp != NULL) 
+    //print distribution for < edge for each edge, > last edge
+    printf("-  Distribution of Idle Time: \n");
+    for (int k = 0; k < d->edges->n; k++)
     {
-        if (temp->value < 0.000002)
-            distribution[0] = distribution[0]  + temp->value;
-        if  (temp->value < 0.000020) 
-            distribution[1] = distribution[1]  + temp->value;
-        if (temp->value < 0.000600)
-            distribution[2] = distribution[2]  + temp->value;
-        distribution[3] = distribution[3]  + temp->value;
-        temp = temp->next;
+        sprintf(label, "%gus", d->edges->at[k] * 1000000);
+        printf("-    # idle < %-11s= %.6f \n", label, d->below[k]/idleTime);
     }
-    
-    //print distribution for <10us, < 100us, < 1000us, > 1000us
-    printf("-  Distribution of Idle Time: \n");
-    printf("-    # idle < 2us        = %.6f \n", distribution[0]/idleTime);
-    printf("-    # idle < 20us       = %.6f \n", distribution[1]/idleTime);
-    printf("-    # idle < 600us      = %.6f \n", distribution[2]/idleTime);
-    printf("-    # idle > 600us      = %.6f \n", distribution[3]/idleTime);
+    printf("-    # idle > %-11s= %.6f \n", label, d->total/idleTime);
 
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 * Notes: Nothing remarkable
 *------------------------------------------------------------------------------*
 * Build Command:
-* gcc -o mm1k mm1k.c -lm
+* gcc -o mm1k mm1k.c -lm -lpthread
 *------------------------------------------------------------------------------*
 * Execute command:
 * ./mm1k
@@ -12,14 +12,6 @@
 * Author: Lucas German Wals Ochoa
 *******************************************************************************/
 
-/*******************************************************************************
-* Includes
-*******************************************************************************/
-#include <stdio.h>              // Needed for printf()
-#include <stdlib.h>             // Needed for exit() and rand()
-#include <unistd.h>             // Needed for getopts()
-#include "utils.h"              // Needed for expntl()
-
 /*******************************************************************************
 * Defined constants and variables
 * NOTE: All TIME constants are defined in seconds!
@@ -28,123 +20,82 @@
 #define ARR_TIME   90.00        // Mean time between arrivals
 #define SERV_TIME  60.00        // Mean service time
 #define CAPACITY   10           // Maximum amount of customers in the system
+#define CORE_EDGES "0.000002,0.000020,0.000600"  // Idle distribution edges
+
+#define MODEL_QUEUE    QUEUE_SHARED
+#define MODEL_SERVERS  1
+#define MODEL_CAPACITY 1
+#define TIME_UNIT      1.0
+#define MODEL_NAME     "mm1k"
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for exit()
+#include "engine.h"             // Needed for simulate() and runModel()
 
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 static void show_usage(char *name);
+void printReport(const Params *p, Stats *st);
 
 /*******************************************************************************
 * Main Function
 *******************************************************************************/
 int main(int argc, char **argv)
 {
-    int opt;    // Hold the options passed as argument
-    double endTime = SIM_TIME;        // Total time to do Simulation
-    double arrTime = ARR_TIME;        // Mean time between arrivals
-    double departTime = SERV_TIME;    // Mean service time
-    int k = CAPACITY;                 // Capacity of system
+    Config cfg;     // Options of the simulation
 
-    double time = 0.0;          // Current Simulation time
-    double nextArrival = 0.0;         // Time for next arrival
-    double nextDeparture = SIM_TIME;  // Time for next departure
-    unsigned int n = 0;           // Actual number of customers in the system
+    configInit(&cfg);
+    if (!parseOptions(argc, argv, "a:A:d:s:G:k:we:t:r:x:C:I:S:R:j:f:o:", &cfg))
+        show_usage( argv[0] );
+    runModel(&cfg, printReport);
+}
 
-    unsigned int departures = 0;  // Total number of customers served
-    double busyTime = 0.0;        // Total busy time
-    double s = 0.0;               // Area of number of customers in system
-    double lastEventTime = time;  // Variable for "last event time"
-    double lastBusyTime;          // Variable for "last start of busy time"
+/*******************************************************************************
+*       printReport(const Params *p, Stats *st)
+********************************************************************************
+* Function that prints the inputs and the outputs of the simulation
+* - Input: *p (inputs of the simulation)
+*           *st (outputs, merged over every replication)
+*******************************************************************************/
+void printReport(const Params *p, Stats *st)
+{
     double x;     // Throughput rate
     double u;     // Utilization of system
     double l;     // Average number of customers in system
     double w;     // Average Sojourn time
 
-    if (argc > 1)
-    {     
-        while ( (opt = getopt(argc, argv, "a:d:s:k:")) != -1 )
-        {
-            switch (opt) {
-                case 'a':
-                    arrTime = atof(optarg);
-                    break;
-                case 'd':
-                    departTime = atof(optarg);
-                    break;
-                case 's':
-                    endTime = atof(optarg);
-                    break;
-                case 'k':
-                    k = atoi(optarg);
-                    break;
-                default:    // '?' unknown option
-                    show_usage( argv[0] );
-            }
-        }
-    }
-
-    // Simulation loop
-    while (time < endTime)
-    {
-        // Arrival occurred
-        if (nextArrival < nextDeparture)
-        {
-            time = nextArrival;
-            if (n < k)  // Actual number of customers is less than system's capacity
-            {
-                s = s + n * (time - lastEventTime);  // Update area under "s" curve
-                n++;    // Customers in system increase
-                if (n == 1)
-                {
-                    lastBusyTime = time;    // Set "last start of busy time"
-                    nextDeparture = time + expntl(departTime);
-                }
-            }
-            lastEventTime = time;   // "last event time" for next event
-            nextArrival = time + expntl(arrTime);
-        }
-        // Departure occurred
-        else
-        {
-            time = nextDeparture;
-            s = s + n * (time - lastEventTime); // Update area under "s" curve
-            n--;    // Customers in system decrease
-            lastEventTime = time;   // "last event time" for next event
-            departures++;           // Increment number of completions
-            if (n > 0)
-                nextDeparture = time + expntl(departTime);
-            else
-            {
-                nextDeparture = SIM_TIME;
-                // Update busy time sum when no customers
-                busyTime = busyTime + time - lastBusyTime;
-            }
-        }
-    }
-
     // Compute outputs
-    x = departures / time;  // Compute throughput rate
-    u = busyTime / time;    // Compute server utilization
-    l = s / time;           // Avg number of customers in the system
+    x = st->departures / st->time;  // Compute throughput rate
+    u = st->busyTime / st->time;    // Compute server utilization
+    l = st->s / st->time;           // Avg number of customers in the system
     w = l / x;              // Avg Sojourn time
 
     // Output results
     printf("<-------------------------------------------------------------> \n");
-    printf("<           *** Results for M/M/1/%d simulation ***           > \n", k);
+    printf("<           *** Results for M/M/1/%d simulation ***           > \n", p->k);
     printf("<-------------------------------------------------------------> \n");
     printf("-  INPUTS: \n");
-    printf("-    Total simulation time        = %.4f sec \n", endTime);
-    printf("-    Mean time between arrivals   = %.4f sec \n", arrTime);
-    printf("-    Mean service time            = %.4f sec \n", departTime);
-    printf("-    System capacity              = %d sec \n", k);
+    printf("-    Total simulation time        = %.4f sec \n", st->warmupTime + st->time);
+    printf("-    Mean time between arrivals   = %.4f sec \n", p->arrTime);
+    if (p->arrivals.type != ARRIVAL_POISSON)
+        printf("-    Arrival process              = %s \n", p->arrivals.name);
+    printf("-    Mean service time            = %.4f sec \n", p->departTime);
+    if (p->service.type != DISTR_EXP)
+        printf("-    Service time distribution    = %s \n", p->service.name);
+    printf("-    System capacity              = %d sec \n", p->k);
     printf("<-------------------------------------------------------------> \n");
     printf("-  OUTPUTS: \n");
-    printf("-    # of Customers served        = %u cust \n", departures);
+    printf("-    # of Customers served        = %lu cust \n", st->departures);
     printf("-    Throughput rate              = %f cust/sec \n", x);
     printf("-    Server utilization           = %f %% \n", 100.0 * u);
     printf("-    Avg # of cust. in system     = %f cust \n", l);
     printf("-    Mean Sojourn time            = %f sec \n", w);
-    printf("<-------------------------------------------------------------> \n");
+    printPercentiles("Waiting time p50/p99/p99.9", &st->waitTimes, 1.0, "sec");
+    printPercentiles("Response time p50/p99/p99.9", &st->responseTimes, 1.0, "sec");
 }
 
 /*******************************************************************************
@@ -160,9 +111,42 @@ static void show_usage(char *name)
     printf("\n");
     printf("Options: \n");
     printf("\t-a\tMean time between arrivals (in seconds) \n");
+    printf("\t-A\tProcess of the arrivals, with the mean of -a (times in its unit):\n");
+    printf("\t  \tpoisson (default), mmpp:ratio:hold, onoff:on:off, sine:amp:period\n");
+    printf("\t  \tor steps:period:m1,m2,... (rate curve repeated every period)\n");
     printf("\t-d\tMean service time (in seconds) \n");
+    printf("\t-G\tDistribution of the service times, with the mean of -d: exp\n");
+    printf("\t  \t(default), det, erlang:k, hyper:scv, lognormal:cv, pareto:alpha\n");
+    printf("\t  \tor weibull:shape\n");
     printf("\t-s\tTotal simulation time (in seconds) \n");
     printf("\t-k\tTotal capacity of the system (in # of customers) \n");
+    printf("\t  \t-a, -d and -k take a value, a list x1,x2,... or a range min:max:step;\n");
+    printf("\t  \tseveral values run a sweep that writes one CSV row per point\n");
+    printf("\t-w\tDelete the warm-up found by MSER-5 from the statistics\n");
+    printf("\t-e\tStop when the mean response time is known to this relative\n");
+    printf("\t  \tprecision, e.g. 0.01 (implies -w, -s is then the longest run)\n");
+    printf("\t-t\tRecord every event of replication 0 in this trace file\n");
+    printf("\t  \t(convert it with trace2json for Perfetto or chrome://tracing)\n");
+    printf("\t-r\tReplay a log of jobs (arrival,service in seconds, CSV or binary)\n");
+    printf("\t  \tinstead of the exponential arrivals and services (-a, -d)\n");
+    printf("\t-x\tSpeed-up of the replayed arrivals, e.g. 2 for twice the load\n");
+    printf("\t-C\tSave the state of the run to this checkpoint file, periodically\n");
+    printf("\t  \tand at the end (replication r > 0 uses <file>.r)\n");
+    printf("\t-I\tSeconds of wall-clock time between checkpoints (default %d)\n", CKPT_INTERVAL);
+    printf("\t--resume\tContinue the run saved in the checkpoint (-C), e.g. with a larger -s\n");
+    printf("\t-S\tSeed of the random streams (default %d)\n", RNG_SEED);
+    printf("\t-R\tNumber of independent replications (default 1)\n");
+    printf("\t-j\tThreads running the replications (default: # of CPUs)\n");
+    printf("\t-f\tFormat of the results: text (report), csv, json (JSON lines)\n");
+    printf("\t  \tor bin (packed doubles); same fields for every simulator\n");
+    printf("\t-o\tFile the results are written to (default: stdout)\n");
+    printf("\t--bench[=n]\tBenchmark a grid of loads, n events per point (default %d):\n", BENCH_EVENTS);
+    printf("\t  \tevents/sec, ns/event, peak RSS and allocations/event (-f json by default)\n");
+    printf("\t--baseline\tBenchmark (-f json) to compare with; fails if a point is %d%% slower\n", (int)(100 * BENCH_TOLERANCE));
+    printf("\t--analytic\tClosed form instead of a simulation (M/M/1/K), with\n");
+    printf("\t  \tthe fields of the results (no simulation is run)\n");
+    printf("\t--validate\tCompare the simulation with its closed form; fails if an output\n");
+    printf("\t  \tdeviates by more than %d%% (and its CI)\n", (int)(100 * VALIDATE_TOLERANCE));
     exit(EXIT_SUCCESS);
 }
 
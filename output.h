@@ -0,0 +1,347 @@
+/*******************************************************************************
+*                        Machine-Readable Result Output
+********************************************************************************
+* Notes: Writes the results of a simulation as records of named fields, one
+* record per simulation point, in one of three formats (-f):
+*   csv     a header line with the field names, then one line per record
+*   json    JSON lines: one object {"name": value, ...} per line
+*   bin     a self-describing header, then one packed row of doubles per record
+* Every simulator writes the same fields in the same order (see fillRecord()
+* in engine.h), so tables of different models can be concatenated and loaded
+* without parsing the text reports.
+*
+* A field is numeric, integer or text. Integer and text fields (model,
+* policy, seed) are constant within a run; bin stores them once, in its
+* header, and its rows only hold the numeric fields. Integers are written
+* with all their digits (a double keeps only 15 to 17). Missing values (NaN)
+* are written as an empty CSV cell, as JSON null and as NaN in bin. Text is
+* escaped: CSV quotes a cell that holds a comma, a quote or a line break and
+* doubles its quotes; JSON escapes quotes, backslashes and control characters.
+*------------------------------------------------------------------------------*
+* Layout of bin (native byte order, little endian on x86):
+*   char     magic[8]       "QSIMBIN1"
+*   uint32   header         size of the header in bytes (multiple of 8)
+*   uint32   fields         numeric fields per row
+*   char     names[]        "name=value\n" per text or integer field, then "name\n" per
+*                           numeric field, padded with '\0' up to header bytes
+*   double   rows[][fields]
+* e.g. in numpy:
+*   h, n = np.fromfile(f, np.uint32, 2, offset=8)
+*   rows = np.fromfile(f, np.float64, offset=h).reshape(-1, n)
+*------------------------------------------------------------------------------*
+* Usage:
+*   Output out;
+*   Record rec;
+*   outputOpen(&out, FORMAT_CSV, "results.csv");     // NULL: stdout
+*   recordInit(&rec);
+*   recordText(&rec, "model", "mm1");
+*   recordValue(&rec, "load", 0.5);
+*   outputWrite(&out, &rec);                          // header on 1st record
+*   outputClose(&out);
+*******************************************************************************/
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>              // Needed for FILE and fprintf()
+#include <stdlib.h>             // Needed for exit()
+#include <string.h>             // Needed for strcmp(), strpbrk(), strlen() and memcpy()
+#include <stdint.h>             // Needed for uint32_t
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for isfinite()
+#include "replicate.h"          // Needed for Estimate
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define MAX_FIELDS     128      // Maximum number of fields of a record
+#define FIELD_NAME     32       // Maximum length of a field name (with '\0')
+#define FIELD_DIGITS   24       // Digits of an integer field (with '\0')
+#define BIN_MAGIC      "QSIMBIN1"
+
+enum {                          // Formats of the results
+    FORMAT_TEXT,                // Report of the model (not machine-readable)
+    FORMAT_CSV,
+    FORMAT_JSON,
+    FORMAT_BIN,
+    NUM_FORMATS
+};
+
+static const char *formatNames[NUM_FORMATS] = { "text", "csv", "json", "bin" };
+
+typedef struct Record {         // Fields of one simulation point
+    int n;                      // Number of fields
+    char name[MAX_FIELDS][FIELD_NAME];
+    double value[MAX_FIELDS];   // Value of a numeric field
+    const char *text[MAX_FIELDS];   // Value of a text field (NULL if numeric)
+    bool integer[MAX_FIELDS];   // Text field holding the digits of an integer
+    char digits[MAX_FIELDS][FIELD_DIGITS];  // Digits of the integer fields
+} Record;
+
+typedef struct Output {         // Destination of the records
+    int format;                 // FORMAT_*
+    FILE *file;                 // File written (stdout if no path is given)
+    unsigned long records;      // Records written so far
+} Output;
+
+/*******************************************************************************
+*       parseFormat(const char *arg, int *format)
+********************************************************************************
+* Function that parses the name of a format
+* - Input: arg (text, csv, json or bin)
+* - Output: *format (FORMAT_*)
+*           bool (false if the name is unknown)
+*******************************************************************************/
+bool parseFormat(const char *arg, int *format)
+{
+    for (int i = 0; i < NUM_FORMATS; i++)
+    {
+        if (strcmp(arg, formatNames[i]) == 0)
+        {
+            *format = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+*       recordInit(Record *rec)
+*       recordValue(Record *rec, const char *name, double value)
+*       recordText(Record *rec, const char *name, const char *text)
+*       recordInteger(Record *rec, const char *name, unsigned long long value)
+*       recordEstimate(Record *rec, const char *name, Estimate *e)
+********************************************************************************
+* Functions that empty a record and append fields to it. recordEstimate()
+* appends two fields: the mean (name) and the half width of its confidence
+* interval (name_ci), the mean NaN if the estimate is empty and the half
+* width NaN with less than 2 replications.
+* - Input: *rec (record to fill)
+*           name (name of the field)
+*           value / text / *e (value of the field; text must outlive *rec)
+*******************************************************************************/
+void recordInit(Record *rec)
+{
+    rec->n = 0;
+}
+
+static int recordAppend(Record *rec, const char *name)
+{
+    size_t len = strlen(name);
+
+    if (rec->n == MAX_FIELDS) {
+        printf("Too many output fields!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (len >= FIELD_NAME)
+        len = FIELD_NAME - 1;
+    memcpy(rec->name[rec->n], name, len);
+    rec->name[rec->n][len] = '\0';
+    rec->value[rec->n] = NAN;
+    rec->text[rec->n] = NULL;
+    rec->integer[rec->n] = false;
+    return rec->n++;
+}
+
+void recordValue(Record *rec, const char *name, double value)
+{
+    rec->value[recordAppend(rec, name)] = value;
+}
+
+void recordText(Record *rec, const char *name, const char *text)
+{
+    rec->text[recordAppend(rec, name)] = text;
+}
+
+void recordInteger(Record *rec, const char *name, unsigned long long value)
+{
+    int i = recordAppend(rec, name);
+
+    snprintf(rec->digits[i], FIELD_DIGITS, "%llu", value);
+    rec->text[i] = rec->digits[i];
+    rec->integer[i] = true;
+}
+
+void recordEstimate(Record *rec, const char *name, Estimate *e)
+{
+    char ci[FIELD_NAME + 4];
+
+    snprintf(ci, sizeof(ci), "%s_ci", name);
+    recordValue(rec, name, (e->n > 0) ? e->mean : NAN);
+    recordValue(rec, ci, estHalfWidth(e));
+}
+
+/*******************************************************************************
+*       outputOpen(Output *out, int format, const char *path)
+********************************************************************************
+* Function that opens the destination of the records
+* - Input: *out (output to open)
+*           format (FORMAT_*)
+*           path (file to create, NULL for stdout)
+*******************************************************************************/
+void outputOpen(Output *out, int format, const char *path)
+{
+    out->format = format;
+    out->records = 0;
+    out->file = (path == NULL) ? stdout : fopen(path, (format == FORMAT_BIN) ? "wb" : "w");
+    if (!out->file) {
+        printf("Cannot open %s!\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*******************************************************************************
+*       outputHeader(Output *out, const Record *rec)
+********************************************************************************
+* Function that writes the header of a table, derived from its first record
+* (nothing for JSON lines, whose records name their fields)
+* - Input: *out (output)
+*           *rec (first record)
+*******************************************************************************/
+void outputHeader(Output *out, const Record *rec)
+{
+    if (out->format == FORMAT_CSV)
+    {
+        for (int i = 0; i < rec->n; i++)
+            fprintf(out->file, (i == 0) ? "%s" : ",%s", rec->name[i]);
+        fprintf(out->file, "\n");
+    }
+    else if (out->format == FORMAT_BIN)
+    {
+        uint32_t header = 16, fields = 0;
+        for (int i = 0; i < rec->n; i++)
+        {
+            if (rec->text[i])
+                header += strlen(rec->name[i]) + strlen(rec->text[i]) + 2;
+            else
+            {
+                header += strlen(rec->name[i]) + 1;
+                fields++;
+            }
+        }
+        uint32_t pad = (8 - header % 8) % 8;
+        header += pad;
+
+        fwrite(BIN_MAGIC, 1, 8, out->file);
+        fwrite(&header, sizeof(header), 1, out->file);
+        fwrite(&fields, sizeof(fields), 1, out->file);
+        for (int i = 0; i < rec->n; i++)
+            if (rec->text[i])
+                fprintf(out->file, "%s=%s\n", rec->name[i], rec->text[i]);
+        for (int i = 0; i < rec->n; i++)
+            if (!rec->text[i])
+                fprintf(out->file, "%s\n", rec->name[i]);
+        for (uint32_t i = 0; i < pad; i++)
+            fputc('\0', out->file);
+    }
+}
+
+/*******************************************************************************
+*       outputCsv(FILE *file, const char *text)
+*       outputJson(FILE *file, const char *text)
+********************************************************************************
+* Functions that write a text field as a CSV cell (quoted if needed, quotes
+* doubled) or as a JSON string (quotes, backslashes and control characters
+* escaped)
+* - Input: *file (destination)
+*           text (value of the field)
+*******************************************************************************/
+void outputCsv(FILE *file, const char *text)
+{
+    if (!strpbrk(text, ",\"\r\n"))
+    {
+        fputs(text, file);
+        return;
+    }
+    fputc('"', file);
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        if (*c == '"')
+            fputc('"', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+void outputJson(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char*)text; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fprintf(file, "\\%c", *c);
+        else if (*c == '\n')
+            fputs("\\n", file);
+        else if (*c == '\t')
+            fputs("\\t", file);
+        else if (*c < 0x20)
+            fprintf(file, "\\u%04x", *c);
+        else
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+/*******************************************************************************
+*       outputWrite(Output *out, const Record *rec)
+********************************************************************************
+* Function that writes a record (and the header before the first one), then
+* flushes it, so the rows of a long sweep can be read while it runs. Every
+* record of an output must have the same fields.
+* - Input: *out (output)
+*           *rec (record to write)
+*******************************************************************************/
+void outputWrite(Output *out, const Record *rec)
+{
+    if (out->records++ == 0)
+        outputHeader(out, rec);
+
+    for (int i = 0; i < rec->n; i++)
+    {
+        bool missing = !rec->text[i] && !isfinite(rec->value[i]);
+
+        switch (out->format) {
+            case FORMAT_JSON:
+                fprintf(out->file, "%s\"%s\":", (i == 0) ? "{" : ",", rec->name[i]);
+                if (rec->integer[i])
+                    fprintf(out->file, "%s", rec->text[i]);
+                else if (rec->text[i])
+                    outputJson(out->file, rec->text[i]);
+                else if (missing)
+                    fprintf(out->file, "null");
+                else
+                    fprintf(out->file, "%.9g", rec->value[i]);
+                break;
+            case FORMAT_BIN:
+                if (!rec->text[i])
+                    fwrite(&rec->value[i], sizeof(double), 1, out->file);
+                break;
+            default:    // FORMAT_CSV
+                if (i > 0)
+                    fputc(',', out->file);
+                if (rec->text[i])
+                    outputCsv(out->file, rec->text[i]);
+                else if (!missing)
+                    fprintf(out->file, "%.9g", rec->value[i]);
+                break;
+        }
+    }
+    if (out->format == FORMAT_JSON)
+        fprintf(out->file, "}\n");
+    else if (out->format == FORMAT_CSV)
+        fprintf(out->file, "\n");
+    fflush(out->file);
+}
+
+/*******************************************************************************
+*       outputClose(Output *out)
+********************************************************************************
+* Function that closes the destination of the records
+* - Input: *out (output to close)
+*******************************************************************************/
+void outputClose(Output *out)
+{
+    if (out->file != stdout)
+        fclose(out->file);
+}
+
+#endif
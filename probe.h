@@ -0,0 +1,171 @@
+/*******************************************************************************
+*                          Hot-Path Instrumentation
+********************************************************************************
+* Notes: Counters of what the event loop does (events by type, random draws,
+* queue and heap operations, allocations) and, optionally, the CPU cycles it
+* spends in each phase (random variates, dispatch, queues, min-search,
+* statistics), to find what makes a run slow. Both compile out unless the
+* simulator is built with them:
+*   -DPROBES          counters
+*   -DPROBE_TIMING    counters and per-phase cycles (rdtsc on x86, else the
+*                     monotonic clock in ns); the clock is read twice per
+*                     timed phase, so expect the run to be slower
+* The counters of a thread are in a thread-local Probes, copied into the
+* outputs of the replication (Stats) at the end of simulate(), so they are
+* merged and written with the results (report or records). A resumed run
+* only counts what it did after its checkpoint.
+*------------------------------------------------------------------------------*
+* Usage:
+*   probeCount(PROBE_FIFO_PUSH);
+*   probeTime(PHASE_RNG, service = expntl(&servStream, mean));
+*******************************************************************************/
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdint.h>             // Needed for uint64_t
+#include <time.h>               // Needed for clock_gettime()
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>          // Needed for __rdtsc()
+#endif
+
+//#define PROBES                // Build with -DPROBES to count the operations
+//#define PROBE_TIMING          // Build with -DPROBE_TIMING to also time the
+                                // phases of the event loop
+#ifdef PROBE_TIMING
+#ifndef PROBES
+#define PROBES
+#endif
+#endif
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+enum {                          // Counters
+    PROBE_ARRIVAL,              // Arrivals
+    PROBE_DROP,                 // Arrivals dropped (system full)
+    PROBE_QUEUED,               // Arrivals that wait in a queue
+    PROBE_DEPARTURE,            // Departures
+    PROBE_IDLE,                 // Departures that leave their server idle
+    PROBE_RNG_DRAW,             // 64-bit draws of the random streams
+    PROBE_FIFO_PUSH,            // Jobs queued
+    PROBE_FIFO_POP,             // Looks at the head of a queue
+    PROBE_HEAP_UPDATE,          // Departure times changed in the heap
+    PROBE_HEAP_MOVE,            // Levels moved by the sifts of the heap
+    PROBE_ALLOC,                // Calls to malloc(), calloc() and realloc()
+    PROBE_ALLOC_BYTES,          // Bytes they requested
+    NUM_PROBES
+};
+
+enum {                          // Timed phases of the event loop
+    PHASE_RNG,                  // Drawing interarrival and service times
+    PHASE_DISPATCH,             // Choosing the server of a job
+    PHASE_QUEUE,                // Queueing and dequeueing jobs
+    PHASE_MIN,                  // Finding and updating the next departure
+    PHASE_STATS,                // Collecting the statistics
+    PHASE_LOOP,                 // Whole loop (the phases and the rest)
+    NUM_PHASES
+};
+
+typedef struct Probes {         // Counters of one run (or of several merged)
+    uint64_t count[NUM_PROBES];
+    uint64_t cycles[NUM_PHASES];
+} Probes;
+
+static const char *probeNames[NUM_PROBES] = {
+    "arrival", "drop", "queued", "departure", "idle", "rng_draw", "fifo_push",
+    "fifo_pop", "heap_update", "heap_move", "alloc", "alloc_bytes" };
+static const char *phaseNames[NUM_PHASES] = {
+    "rng", "dispatch", "queue", "min", "stats", "loop" };
+
+static _Thread_local Probes probes;     // Counters of this thread
+
+/*******************************************************************************
+*       probeTsc()
+********************************************************************************
+* Function that reads the cycle counter (ns of the monotonic clock if there
+* is none)
+* - Output: uint64_t (cycles)
+*******************************************************************************/
+static inline uint64_t probeTsc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+#ifdef PROBES
+#define probeCount(k)       (probes.count[k]++)
+#define probeAdd(k, n)      (probes.count[k] += (n))
+#else
+#define probeCount(k)       ((void)0)
+#define probeAdd(k, n)      ((void)0)
+#endif
+
+// Run the statements and, with PROBE_TIMING, add their cycles to the phase
+#ifdef PROBE_TIMING
+#define probeTime(phase, ...)   do { uint64_t probeStart = probeTsc(); __VA_ARGS__; \
+                                     probes.cycles[phase] += probeTsc() - probeStart; } while (0)
+#else
+#define probeTime(phase, ...)   do { __VA_ARGS__; } while (0)
+#endif
+
+/*******************************************************************************
+*       probeMerge(Probes *dst, const Probes *src)
+********************************************************************************
+* Function that adds the counters of a run to others
+* - Input: *src (counters to add)
+* - Output: *dst (sum of the counters)
+*******************************************************************************/
+void probeMerge(Probes *dst, const Probes *src)
+{
+    for (int k = 0; k < NUM_PROBES; k++)
+        dst->count[k] += src->count[k];
+    for (int k = 0; k < NUM_PHASES; k++)
+        dst->cycles[k] += src->cycles[k];
+}
+
+/*******************************************************************************
+*       probeSince(Probes *dst, const Probes *start)
+********************************************************************************
+* Function that returns what the counters of this thread did since a copy
+* - Input: *start (copy of the counters taken at the start)
+* - Output: *dst (counters since the copy)
+*******************************************************************************/
+void probeSince(Probes *dst, const Probes *start)
+{
+    for (int k = 0; k < NUM_PROBES; k++)
+        dst->count[k] = probes.count[k] - start->count[k];
+    for (int k = 0; k < NUM_PHASES; k++)
+        dst->cycles[k] = probes.cycles[k] - start->cycles[k];
+}
+
+/*******************************************************************************
+*       printProbes(const Probes *pr)
+********************************************************************************
+* Function that prints the counters per event and the share of the loop
+* spent in each phase (if it was timed)
+* - Input: *pr (counters of the run)
+*******************************************************************************/
+void printProbes(const Probes *pr)
+{
+    double events = pr->count[PROBE_ARRIVAL] + pr->count[PROBE_DEPARTURE];
+
+    if (events == 0)
+        events = 1;
+    printf("<-------------------------------------------------------------> \n");
+    printf("-  PROBES (per event = per arrival or departure): \n");
+    for (int k = 0; k < NUM_PROBES; k++)
+        printf("-    %-28s = %llu (%.4f per event) \n", probeNames[k],
+               (unsigned long long)pr->count[k], pr->count[k] / events);
+    for (int k = 0; k < NUM_PHASES && pr->cycles[PHASE_LOOP] > 0; k++)
+        printf("-    cycles %-21s = %llu (%.1f per event, %.1f%% of the loop) \n", phaseNames[k],
+               (unsigned long long)pr->cycles[k], pr->cycles[k] / events,
+               100.0 * pr->cycles[k] / pr->cycles[PHASE_LOOP]);
+}
+
+#endif
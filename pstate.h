@@ -0,0 +1,364 @@
+/*******************************************************************************
+*                       Core Frequencies (DVFS)
+********************************************************************************
+* Notes: Performance states (P-states) of the cores. A table (-V) lists the
+* frequencies of a core from the lowest to the highest as freq:power, in GHz
+* and W (the power of a busy core at that frequency). The mean service time
+* (-d) is the one at the highest frequency; a job served at frequency f takes
+* fmax / f times longer. Each time a core starts a job, a governor (-F) picks
+* its frequency from the recent utilization of the core:
+*   off         no frequency scaling (the default, nothing is modelled)
+*   performance the highest frequency
+*   powersave   the lowest frequency
+*   ondemand    the lowest frequency above fmin + util (fmax - fmin), and
+*               fmax above UP_THRESHOLD, util being the busy fraction
+*   schedutil   the lowest frequency above 1.25 fmax util, util being the
+*               busy fraction scaled by f / fmax (frequency invariant)
+*   <freq>      always this frequency of the table, e.g. 2.0
+* The governors take an optional time constant, e.g. ondemand:5000 (in the
+* unit of the model, PSTATE_WINDOW by default): the utilization is a moving
+* average of the busy time of the core that decays with it, updated when the
+* core starts a job or goes idle (like the PELT signal of Linux).
+*------------------------------------------------------------------------------*
+* Usage:
+*   PStates ps;
+*   pstateInit(&ps, &table, &gov, c);
+*   service *= pstateJob(&ps, &pst, core, time, busy);   // core starts a job
+*   pstateBusy(&ps, &pst, core, service);                // ... that lasts service
+*   pstateIdle(&ps, core, time);                         // core goes idle
+*******************************************************************************/
+#ifndef PSTATE_H
+#define PSTATE_H
+
+#include <stdio.h>              // Needed for printf() and snprintf()
+#include <stdlib.h>             // Needed for calloc(), malloc(), strtod() and exit()
+#include <string.h>             // Needed for strncmp(), strchr() and memset()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for exp(), fabs() and isfinite()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define PSTATE_MAX     16       // Maximum number of frequencies of a table
+#define UP_THRESHOLD   0.80     // Utilization that sends ondemand to fmax
+#define SCHED_MARGIN   1.25     // Headroom of schedutil over the utilization
+
+enum {                          // Governors
+    GOV_OFF,
+    GOV_PERFORMANCE,
+    GOV_POWERSAVE,
+    GOV_ONDEMAND,
+    GOV_SCHEDUTIL,
+    GOV_FIXED,                  // Named by the frequency
+    NUM_GOVERNORS
+};
+
+static const char *governorNames[NUM_GOVERNORS] = {
+    "off", "performance", "powersave", "ondemand", "schedutil", "userspace" };
+
+typedef struct PStateTable {    // Frequencies of a core, lowest first
+    int n;                      // Number of frequencies
+    double freq[PSTATE_MAX];    // Frequency (GHz)
+    double power[PSTATE_MAX];   // Power of a busy core at the frequency (W)
+} PStateTable;
+
+typedef struct Governor {       // Governor chosen on the command line
+    int type;                   // GOV_*
+    int fixed;                  // Frequency of GOV_FIXED
+    double window;              // Time constant of the utilization
+    char name[32];              // As given to -F, e.g. "ondemand:5000"
+} Governor;
+
+typedef struct PStates {        // Frequencies of the cores of a run
+    const PStateTable *t;       // Frequencies
+    Governor gov;               // Governor
+    int c;                      // Number of cores
+    double *util;               // Utilization of each core
+    double *last;               // Last update of the utilization of each core
+    int *level;                 // Frequency of each core
+} PStates;
+
+typedef struct PStateStats {    // Outputs of the frequencies (summed over the cores)
+    double time[PSTATE_MAX];    // Busy time at each frequency
+    unsigned long jobs[PSTATE_MAX]; // Jobs served at each frequency
+    unsigned long changes;      // Changes of frequency
+} PStateStats;
+
+/*******************************************************************************
+*       parsePStates(const char *arg, PStateTable *t)
+********************************************************************************
+* Function that parses a table of frequencies "freq:power,...", lowest first
+* - Input: arg (table of frequencies)
+* - Output: *t (parsed table)
+*           bool (false if the table is invalid)
+*******************************************************************************/
+bool parsePStates(const char *arg, PStateTable *t)
+{
+    const char *at = arg;
+
+    memset(t, 0, sizeof(*t));   // Compared bytewise by the checkpoints
+    while (*at != '\0')
+    {
+        char *end;
+
+        if (t->n == PSTATE_MAX)
+            return false;
+        t->freq[t->n] = strtod(at, &end);
+        if (*end != ':' || t->freq[t->n] <= 0)
+            return false;
+        if (t->n > 0 && t->freq[t->n] <= t->freq[t->n - 1])
+            return false;
+        t->power[t->n] = strtod(end + 1, &end);
+        if ((*end != ',' && *end != '\0') || t->power[t->n] < 0)
+            return false;
+        t->n++;
+        at = (*end == ',') ? end + 1 : end;
+    }
+    return t->n > 0;
+}
+
+/*******************************************************************************
+*       parseGovernor(const char *arg, const PStateTable *t, double window,
+*                     Governor *gov)
+********************************************************************************
+* Function that parses a governor "name[:window]", or a frequency of the table
+* - Input: arg (governor, see the notes above)
+*           *t (table of frequencies)
+*           window (default time constant of the utilization)
+* - Output: *gov (parsed governor)
+*           bool (false if arg is neither)
+*******************************************************************************/
+bool parseGovernor(const char *arg, const PStateTable *t, double window, Governor *gov)
+{
+    const char *colon = strchr(arg, ':');
+    size_t len = colon ? (size_t)(colon - arg) : strlen(arg);
+    char *end;
+
+    memset(gov, 0, sizeof(*gov));
+    gov->type = -1;
+    gov->window = window;
+    if (colon)
+    {
+        gov->window = strtod(colon + 1, &end);
+        if (end == colon + 1 || *end != '\0' || !isfinite(gov->window))
+            return false;
+    }
+    snprintf(gov->name, sizeof(gov->name), "%s", arg);
+    for (int i = 0; i < GOV_FIXED; i++)
+        if (strlen(governorNames[i]) == len && strncmp(arg, governorNames[i], len) == 0)
+            gov->type = i;
+    if (gov->type < 0 && !colon)
+    {
+        double freq = strtod(arg, &end);
+        for (int i = 0; i < t->n && *end == '\0'; i++)
+        {
+            if (fabs(freq - t->freq[i]) < 1e-9)
+            {
+                gov->type = GOV_FIXED;
+                gov->fixed = i;
+            }
+        }
+    }
+    return gov->type >= 0 && gov->window > 0;
+}
+
+/*******************************************************************************
+*       pstateInit(PStates *ps, const PStateTable *t, const Governor *gov, int c)
+********************************************************************************
+* Function that initializes the frequencies of c idle cores, at the highest
+* - Input: *t (table of frequencies, must outlive ps)
+*           *gov (governor)
+*           c (number of cores)
+* - Output: *ps (frequencies)
+*******************************************************************************/
+void pstateInit(PStates *ps, const PStateTable *t, const Governor *gov, int c)
+{
+    ps->t = t;
+    ps->gov = *gov;
+    ps->c = c;
+    ps->util = (double*)calloc(c, sizeof(double));
+    ps->last = (double*)calloc(c, sizeof(double));
+    ps->level = (int*)malloc(c * sizeof(int));
+    if (!ps->util || !ps->last || !ps->level) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < c; i++)
+        ps->level[i] = t->n - 1;
+}
+
+/*******************************************************************************
+*       pstateFree(PStates *ps)
+********************************************************************************
+* Function that releases the frequencies of the cores
+* - Input: *ps (frequencies)
+*******************************************************************************/
+void pstateFree(PStates *ps)
+{
+    free(ps->util);
+    free(ps->last);
+    free(ps->level);
+}
+
+/*******************************************************************************
+*       pstateStatsMerge(PStateStats *dst, const PStateStats *src)
+********************************************************************************
+* Function that adds the outputs of the frequencies of a run to others
+* - Input: *src (outputs to add)
+* - Output: *dst (sum of the outputs)
+*******************************************************************************/
+void pstateStatsMerge(PStateStats *dst, const PStateStats *src)
+{
+    for (int l = 0; l < PSTATE_MAX; l++)
+    {
+        dst->time[l] += src->time[l];
+        dst->jobs[l] += src->jobs[l];
+    }
+    dst->changes += src->changes;
+}
+
+/*******************************************************************************
+*       pstateUpdate(PStates *ps, int core, double time, bool busy)
+********************************************************************************
+* Function that brings the utilization of a core up to a time
+* - Input: *ps (frequencies)
+*           core (core)
+*           time (current time)
+*           busy (the core was busy since the last update, else idle)
+*******************************************************************************/
+static inline void pstateUpdate(PStates *ps, int core, double time, bool busy)
+{
+    double decay = exp(-(time - ps->last[core]) / ps->gov.window);
+    double load = 0.0;
+
+    if (busy)   // Scaled by the frequency for schedutil
+        load = (ps->gov.type == GOV_SCHEDUTIL)
+               ? ps->t->freq[ps->level[core]] / ps->t->freq[ps->t->n - 1] : 1.0;
+    ps->util[core] = load + (ps->util[core] - load) * decay;
+    ps->last[core] = time;
+}
+
+/*******************************************************************************
+*       pstateJob(PStates *ps, PStateStats *pst, int core, double time, bool busy)
+********************************************************************************
+* Function that lets the governor pick the frequency of a core that starts a
+* job, and returns how much longer the job takes at this frequency
+* - Input: *ps (frequencies)
+*           core (core starting a job)
+*           time (current time)
+*           busy (the core was busy until now, else idle)
+* - Output: *pst (outputs)
+*           double (fmax / f)
+*******************************************************************************/
+double pstateJob(PStates *ps, PStateStats *pst, int core, double time, bool busy)
+{
+    const PStateTable *t = ps->t;
+    double fmax = t->freq[t->n - 1], target = fmax;
+    int level = 0;
+
+    pstateUpdate(ps, core, time, busy);
+    switch (ps->gov.type) {
+        case GOV_POWERSAVE:
+            target = t->freq[0];
+            break;
+        case GOV_ONDEMAND:
+            if (ps->util[core] <= UP_THRESHOLD)
+                target = t->freq[0] + ps->util[core] * (fmax - t->freq[0]);
+            break;
+        case GOV_SCHEDUTIL:
+            target = SCHED_MARGIN * fmax * ps->util[core];
+            break;
+        case GOV_FIXED:
+            target = t->freq[ps->gov.fixed];
+            break;
+    }
+    while (level < t->n - 1 && t->freq[level] < target - 1e-9)
+        level++;
+    if (level != ps->level[core])
+        pst->changes++;
+    pst->jobs[level]++;
+    ps->level[core] = level;
+    return fmax / t->freq[level];
+}
+
+/*******************************************************************************
+*       pstateBusy(const PStates *ps, PStateStats *pst, int core, double busy)
+********************************************************************************
+* Function that accounts for busy time of a core at its current frequency
+* - Input: *ps (frequencies)
+*           core (busy core)
+*           busy (time the core stays busy)
+* - Output: *pst (outputs)
+*******************************************************************************/
+static inline void pstateBusy(const PStates *ps, PStateStats *pst, int core, double busy)
+{
+    pst->time[ps->level[core]] += busy;
+}
+
+/*******************************************************************************
+*       pstateIdle(PStates *ps, int core, double time)
+********************************************************************************
+* Function that records that a core goes idle
+* - Input: *ps (frequencies)
+*           core (core going idle)
+*           time (current time)
+*******************************************************************************/
+static inline void pstateIdle(PStates *ps, int core, double time)
+{
+    pstateUpdate(ps, core, time, true);
+}
+
+/*******************************************************************************
+*       pstateEnergy(const PStateTable *t, const PStateStats *pst)
+********************************************************************************
+* Function that computes the energy of the busy cores
+* - Input: *t (table of frequencies)
+*           *pst (outputs)
+* - Output: double (energy, W x unit of time)
+*******************************************************************************/
+double pstateEnergy(const PStateTable *t, const PStateStats *pst)
+{
+    double energy = 0.0;
+
+    for (int l = 0; l < t->n; l++)
+        energy += t->power[l] * pst->time[l];
+    return energy;
+}
+
+/*******************************************************************************
+*       printPStates(const PStateTable *t, const char *governor,
+*                    const PStateStats *pst, double time, int c, double unit)
+********************************************************************************
+* Function that prints the busy time at each frequency and the power of the
+* busy cores
+* - Input: *t (table of frequencies)
+*           governor (name of the governor)
+*           *pst (outputs)
+*           time (length of the run)
+*           c (number of cores)
+*           unit (seconds per unit of time)
+*******************************************************************************/
+void printPStates(const PStateTable *t, const char *governor, const PStateStats *pst,
+                  double time, int c, double unit)
+{
+    double busy = 0.0;
+    unsigned long jobs = 0;
+
+    for (int l = 0; l < t->n; l++)
+    {
+        busy += pst->time[l];
+        jobs += pst->jobs[l];
+    }
+    printf("<-------------------------------------------------------------> \n");
+    printf("-  CORE FREQUENCIES (governor %s): \n", governor);
+    for (int l = 0; l < t->n; l++)
+        printf("-    %5.2f GHz busy time           = %f %% (%f %% of the run, %lu jobs, %g W) \n",
+               t->freq[l], 100.0 * pst->time[l] / (busy ? busy : 1), 100.0 * pst->time[l] / (time * c),
+               pst->jobs[l], t->power[l]);
+    printf("-    Frequency changes            = %lu (%f per job) \n", pst->changes,
+           (double)pst->changes / (jobs ? jobs : 1));
+    printf("-    Busy energy                  = %f J (%f W per core) \n",
+           pstateEnergy(t, pst) * unit, pstateEnergy(t, pst) / (time * c));
+}
+
+#endif
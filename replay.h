@@ -0,0 +1,285 @@
+/*******************************************************************************
+*                           Trace-Driven Replay
+********************************************************************************
+* Notes: Replaces the exponential arrivals and services by a log of real jobs
+* (-r file): one (arrival timestamp, service duration) pair per job, in
+* seconds, sorted by arrival. Two formats are read, both through mmap():
+*   CSV     "arrival,service" per line; lines that do not start with a
+*           number (header, # comments) are skipped, and further columns
+*           after the service are ignored
+*   binary  the 8 bytes "QSIMRPL1", then pairs of doubles (native order),
+*           e.g. in numpy: f.write(b"QSIMRPL1"); np.column_stack((a, s)).tofile(f)
+* The parser reads ahead: it converts REPLAY_BLOCK jobs at a time into a block
+* that the event loop consumes like the blocks of exponential variates, and
+* asks the kernel to prefetch the next REPLAY_AHEAD bytes of the file.
+*
+* A job without a valid service, with a negative or infinite one, or with an
+* infinite arrival stops the run with the line (or the job, binary) at fault.
+*
+* Arrivals are shifted so the first job arrives at 0 and divided by the scale
+* (-x): a scale of 2 replays the same jobs twice as fast, i.e. at twice the
+* load. Service durations are kept as logged.
+*------------------------------------------------------------------------------*
+* Usage:
+*   Replay rp;
+*   double arrival, service;
+*   replayOpen(&rp, "requests.csv", 2.0, TIME_UNIT);
+*   while (replayNext(&rp, &arrival, &service)) ...  // in the unit of the model
+*   replayClose(&rp);
+*******************************************************************************/
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for strtod() and exit()
+#include <string.h>             // Needed for memcmp() and memcpy()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for NAN, isnan() and isfinite()
+#include <fcntl.h>              // Needed for open()
+#include <unistd.h>             // Needed for close()
+#include <sys/mman.h>           // Needed for mmap() and madvise()
+#include <sys/stat.h>           // Needed for fstat()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define REPLAY_MAGIC   "QSIMRPL1"
+#define REPLAY_BLOCK   1024     // Jobs converted per refill of the block
+#define REPLAY_AHEAD   (1 << 20)    // Bytes of the file prefetched ahead
+#define REPLAY_LINE    128      // Longest CSV line parsed
+
+typedef struct Replay {         // Reader of a job log
+    const char *path;           // Name of the file (for the error messages)
+    int fd;                     // Log file
+    const char *data;           // Mapping of the whole file
+    size_t size;                // Bytes of the file
+    size_t pos;                 // Next byte to parse
+    size_t prefetched;          // Bytes already prefetched
+    unsigned long line;         // Line (CSV) or job (binary) last parsed
+    bool binary;                // Binary log (else CSV)
+    double scale;               // Arrival speed-up (-x)
+    double unit;                // Seconds per unit of time of the model
+    double first;               // Timestamp of the first job (sec), NAN before it
+    double last;                // Arrival of the last job read (sec)
+    int next;                   // Next unused job of the block
+    int count;                  // Jobs in the block
+    double arrival[REPLAY_BLOCK];   // Arrival of each job (model unit)
+    double service[REPLAY_BLOCK];   // Service of each job (model unit)
+} Replay;
+
+/*******************************************************************************
+*       replayOpen(Replay *rp, const char *path, double scale, double unit)
+********************************************************************************
+* Function that maps a job log and detects its format
+* - Input: *rp (reader to open)
+*           path (log file)
+*           scale (arrival speed-up, 1 to replay the log as is)
+*           unit (seconds per unit of time of the model)
+*******************************************************************************/
+void replayOpen(Replay *rp, const char *path, double scale, double unit)
+{
+    struct stat info;
+
+    rp->path = path;
+    rp->fd = open(path, O_RDONLY);
+    if (rp->fd < 0 || fstat(rp->fd, &info) != 0) {
+        printf("Cannot open %s!\n", path);
+        exit(EXIT_FAILURE);
+    }
+    rp->size = info.st_size;
+    rp->data = NULL;
+    if (rp->size > 0)
+    {
+        rp->data = (const char*)mmap(NULL, rp->size, PROT_READ, MAP_PRIVATE, rp->fd, 0);
+        if (rp->data == MAP_FAILED) {
+            printf("Cannot map %s!\n", path);
+            exit(EXIT_FAILURE);
+        }
+        madvise((void*)rp->data, rp->size, MADV_SEQUENTIAL);
+    }
+    rp->binary = (rp->size >= 8 && memcmp(rp->data, REPLAY_MAGIC, 8) == 0);
+    rp->pos = rp->binary ? 8 : 0;
+    rp->prefetched = 0;
+    rp->line = 0;
+    rp->scale = scale;
+    rp->unit = unit;
+    rp->first = NAN;
+    rp->last = -INFINITY;
+    rp->next = 0;
+    rp->count = 0;
+}
+
+/*******************************************************************************
+*       replayParse(Replay *rp, double *arrival, double *service)
+********************************************************************************
+* Function that parses the next job of the file, in seconds
+* - Input: *rp (reader)
+* - Output: *arrival, *service (timestamp and duration of the job)
+*           bool (false at the end of the file)
+*******************************************************************************/
+bool replayParse(Replay *rp, double *arrival, double *service)
+{
+    if (rp->binary)
+    {
+        double pair[2];
+        if (rp->pos + sizeof(pair) > rp->size)
+            return false;
+        memcpy(pair, rp->data + rp->pos, sizeof(pair));
+        rp->pos += sizeof(pair);
+        rp->line++;
+        *arrival = pair[0];
+        *service = pair[1];
+        return true;
+    }
+
+    while (rp->pos < rp->size)
+    {
+        // Copy the line, the mapping is not terminated by '\0'
+        const char *start = rp->data + rp->pos;
+        const char *nl = (const char*)memchr(start, '\n', rp->size - rp->pos);
+        size_t len = nl ? (size_t)(nl - start) : rp->size - rp->pos;
+        char line[REPLAY_LINE];
+        char *end;
+
+        rp->pos += len + 1;
+        rp->line++;
+        if (len >= REPLAY_LINE)
+            len = REPLAY_LINE - 1;
+        memcpy(line, start, len);
+        line[len] = '\0';
+
+        *arrival = strtod(line, &end);
+        if (end == line)
+            continue;       // Header or comment
+        while (*end == ',' || *end == ' ' || *end == '\t' || *end == ';')
+            end++;
+        const char *field = end;
+        *service = strtod(field, &end);
+        while (*end == ' ' || *end == '\t' || *end == '\r')
+            end++;
+        if (end == field || (*end != '\0' && *end != ',' && *end != ';')) {
+            printf("%s, line %lu: invalid service time!\n", rp->path, rp->line);
+            exit(EXIT_FAILURE);
+        }
+        return true;
+    }
+    return false;
+}
+
+/*******************************************************************************
+*       replayFill(Replay *rp)
+********************************************************************************
+* Function that converts the next REPLAY_BLOCK jobs to the unit of the model
+* and prefetches the part of the file that follows them
+* - Input: *rp (reader)
+*******************************************************************************/
+void replayFill(Replay *rp)
+{
+    double arrival, service;
+
+    rp->count = 0;
+    while (rp->count < REPLAY_BLOCK && replayParse(rp, &arrival, &service))
+    {
+        if (!isfinite(arrival)) {
+            printf("%s, %s %lu: invalid arrival time %g!\n", rp->path,
+                   rp->binary ? "job" : "line", rp->line, arrival);
+            exit(EXIT_FAILURE);
+        }
+        if (!isfinite(service) || service < 0) {
+            printf("%s, %s %lu: invalid service time %g!\n", rp->path,
+                   rp->binary ? "job" : "line", rp->line, service);
+            exit(EXIT_FAILURE);
+        }
+        if (arrival < rp->last) {
+            printf("%s, %s %lu: arrivals are not sorted (%g after %g)!\n", rp->path,
+                   rp->binary ? "job" : "line", rp->line, arrival, rp->last);
+            exit(EXIT_FAILURE);
+        }
+        if (isnan(rp->first))
+            rp->first = arrival;
+        rp->last = arrival;
+        rp->arrival[rp->count] = (arrival - rp->first) / (rp->scale * rp->unit);
+        rp->service[rp->count] = service / rp->unit;
+        rp->count++;
+    }
+    rp->next = 0;
+
+    if (rp->pos + REPLAY_AHEAD / 2 > rp->prefetched && rp->prefetched < rp->size)
+    {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t from = rp->pos & ~(page - 1);
+        size_t bytes = (from + REPLAY_AHEAD > rp->size) ? rp->size - from : REPLAY_AHEAD;
+        madvise((void*)(rp->data + from), bytes, MADV_WILLNEED);
+        rp->prefetched = from + bytes;
+    }
+}
+
+/*******************************************************************************
+*       replayNext(Replay *rp, double *arrival, double *service)
+********************************************************************************
+* Function that returns the next job of the log
+* - Input: *rp (reader)
+* - Output: *arrival (arrival time of the job, in the unit of the model)
+*           *service (service time of the job, in the unit of the model)
+*           bool (false once every job has been read)
+*******************************************************************************/
+static inline bool replayNext(Replay *rp, double *arrival, double *service)
+{
+    if (rp->next == rp->count)
+    {
+        replayFill(rp);
+        if (rp->count == 0)
+            return false;
+    }
+    *arrival = rp->arrival[rp->next];
+    *service = rp->service[rp->next++];
+    return true;
+}
+
+/*******************************************************************************
+*       replayClose(Replay *rp)
+********************************************************************************
+* Function that unmaps and closes a job log
+* - Input: *rp (reader to close)
+*******************************************************************************/
+void replayClose(Replay *rp)
+{
+    if (rp->data)
+        munmap((void*)rp->data, rp->size);
+    close(rp->fd);
+}
+
+/*******************************************************************************
+*       replayMeans(const char *path, double scale, double unit,
+*                   double *arrTime, double *servTime)
+********************************************************************************
+* Function that reads a whole job log once to find its mean time between
+* arrivals and mean service time (the inputs printed in the reports)
+* - Input: path (log file)
+*           scale (arrival speed-up)
+*           unit (seconds per unit of time of the model)
+* - Output: *arrTime, *servTime (means, in the unit of the model)
+*           bool (false if the log has less than two jobs)
+*******************************************************************************/
+bool replayMeans(const char *path, double scale, double unit, double *arrTime, double *servTime)
+{
+    Replay rp;
+    double arrival, service, last = 0.0, total = 0.0;
+    unsigned long jobs = 0;
+
+    replayOpen(&rp, path, scale, unit);
+    while (replayNext(&rp, &arrival, &service))
+    {
+        last = arrival;
+        total += service;
+        jobs++;
+    }
+    replayClose(&rp);
+    if (jobs < 2)
+        return false;
+    *arrTime = last / (jobs - 1);
+    *servTime = total / jobs;
+    return true;
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*******************************************************************************
+*                        Independent Replications
+********************************************************************************
+* Notes: Runs R replications of a simulation on a pool of threads and turns
+* their per-replication outputs into confidence intervals. Replication r draws
+* from its own random streams (see rngStreams()), so results do not depend on
+* the number of threads nor on the order in which replications complete.
+* Workers pick the next pending replication from a shared atomic counter, so
+* threads that finish early keep pulling work until none is left.
+*------------------------------------------------------------------------------*
+* Usage:
+*   void runOne(void *ctx, int rep) { ... simulate replication rep ... }
+*   runReplications(runOne, &ctx, reps, threads);
+*
+*   Estimate x;
+*   estInit(&x);
+*   for (int r = 0; r < reps; r++)
+*       estAdd(&x, throughput[r]);
+*   printEstimate("Throughput rate", &x, "cust/sec");
+*******************************************************************************/
+#ifndef REPLICATE_H
+#define REPLICATE_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for malloc() and exit()
+#include <math.h>               // Needed for sqrt() and NAN
+#include <pthread.h>            // Needed for pthread_create()
+#include <unistd.h>             // Needed for sysconf()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define CI_LEVEL       "95%"    // Confidence level of the reported intervals
+#define CI_Z           1.959964 // Normal quantile matching CI_LEVEL
+
+typedef void (*RepFunc)(void *ctx, int rep);
+
+typedef struct RepPool {        // Work shared by the threads of the pool
+    RepFunc fn;                 // Function running one replication
+    void *ctx;                  // Argument passed to fn
+    int reps;                   // Number of replications
+    int next;                   // Next replication not yet started (atomic)
+} RepPool;
+
+typedef struct Estimate {       // Running mean and variance (Welford)
+    int n;
+    double mean;
+    double m2;                  // Sum of squared deviations from the mean
+} Estimate;
+
+// Student t quantiles for a two-sided 95% interval, 1 to 30 degrees of freedom
+static const double tTable[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+
+/*******************************************************************************
+*       defaultThreads()
+********************************************************************************
+* Function that returns the number of online CPUs, used when -j is not given
+* - Output: int (number of threads, at least 1)
+*******************************************************************************/
+int defaultThreads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+}
+
+/*******************************************************************************
+*       repWorker(void *arg)
+********************************************************************************
+* Thread body: runs pending replications until every one has been started
+* - Input: arg (RepPool shared by the threads)
+*******************************************************************************/
+void* repWorker(void *arg)
+{
+    RepPool *pool = (RepPool*)arg;
+
+    for (;;)
+    {
+        int rep = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (rep >= pool->reps)
+            break;
+        pool->fn(pool->ctx, rep);
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+*       runReplications(RepFunc fn, void *ctx, int reps, int threads)
+********************************************************************************
+* Function that calls fn(ctx, rep) for rep = 0 .. reps-1 on up to threads
+* threads (the calling thread included) and returns when all are done
+* - Input: fn (function running one replication)
+*           ctx (argument passed to fn)
+*           reps (number of replications)
+*           threads (maximum number of threads)
+*******************************************************************************/
+void runReplications(RepFunc fn, void *ctx, int reps, int threads)
+{
+    RepPool pool = { fn, ctx, reps, 0 };
+
+    if (threads > reps)
+        threads = reps;
+    if (threads < 1)
+        threads = 1;
+
+    pthread_t tid[threads];
+    for (int t = 1; t < threads; t++)
+    {
+        if (pthread_create(&tid[t], NULL, repWorker, &pool) != 0) {
+            printf("Thread creation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    repWorker(&pool);
+    for (int t = 1; t < threads; t++)
+        pthread_join(tid[t], NULL);
+}
+
+/*******************************************************************************
+*       estInit(Estimate *e) / estAdd(Estimate *e, double x)
+********************************************************************************
+* Functions that reset an estimate and add the value of one replication
+* - Input: *e (estimate to update)
+*           x (value observed by one replication)
+*******************************************************************************/
+void estInit(Estimate *e)
+{
+    e->n = 0;
+    e->mean = 0.0;
+    e->m2 = 0.0;
+}
+
+void estAdd(Estimate *e, double x)
+{
+    double delta = x - e->mean;
+
+    e->n++;
+    e->mean += delta / e->n;
+    e->m2 += delta * (x - e->mean);
+}
+
+/*******************************************************************************
+*       estHalfWidth(Estimate *e)
+********************************************************************************
+* Function that returns the half width of the CI_LEVEL confidence interval of
+* the mean, using the Student t distribution with n-1 degrees of freedom
+* (Cornish-Fisher expansion beyond the table)
+* - Input: *e (estimate)
+* - Output: double (half width, NaN with less than 2 replications)
+*******************************************************************************/
+double estHalfWidth(Estimate *e)
+{
+    int df = e->n - 1;
+    double t;
+
+    if (df < 1)
+        return NAN;
+    if (df <= 30)
+        t = tTable[df - 1];
+    else
+    {
+        double z = CI_Z, z3 = z * z * z, z5 = z3 * z * z;
+        t = z + (z3 + z) / (4.0 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * df * df);
+    }
+    return t * sqrt(e->m2 / df / e->n);
+}
+
+/*******************************************************************************
+*       printEstimate(const char *label, Estimate *e, const char *unit)
+********************************************************************************
+* Function that prints one line "mean +/- half width" of the report
+* - Input: label (name of the metric)
+*           *e (estimate)
+*           unit (unit of the metric)
+*******************************************************************************/
+void printEstimate(const char *label, Estimate *e, const char *unit)
+{
+    printf("-    %-29s= %g +/- %g %s \n", label, e->mean, estHalfWidth(e), unit);
+}
+
+#endif
@@ -0,0 +1,190 @@
+/*******************************************************************************
+*                          Random Number Streams
+********************************************************************************
+* Notes: xoshiro256++ generator (Blackman & Vigna) with jump-ahead. Each source
+* of randomness of a simulation (arrivals, services, dispatch) draws from its
+* own stream; stream i+1 starts 2^128 draws after stream i, so the streams
+* never overlap. A run is fully determined by its master seed, and
+* independent replications are split off with rngLongJump() (2^192 draws).
+*******************************************************************************/
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>             // Needed for uint64_t
+#include "probe.h"              // Needed for probeCount()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define RNG_SEED       1        // Default master seed
+
+enum {                          // Streams of a simulation run
+    STREAM_ARRIVAL,             // Interarrival times
+    STREAM_SERVICE,             // Service times
+    STREAM_DISPATCH,            // Choice of the server
+    NUM_STREAMS
+};
+
+typedef struct Rng {            // State of one stream
+    uint64_t s[4];
+} Rng;
+
+/*******************************************************************************
+*       rngNext(Rng *rng)
+********************************************************************************
+* Function that draws the next 64 random bits of a stream
+* - Input: *rng (stream to draw from)
+* - Output: uint64_t (random bits)
+*******************************************************************************/
+static inline uint64_t rngRotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rngNext(Rng *rng)
+{
+    uint64_t *s = rng->s;
+    uint64_t result = rngRotl(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+
+    probeCount(PROBE_RNG_DRAW);
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rngRotl(s[3], 45);
+    return result;
+}
+
+/*******************************************************************************
+*       rngUniform(Rng *rng)
+********************************************************************************
+* Function to generate a uniformly distributed double in the open interval
+* (0, 1), so that it can be passed to log() safely
+* - Input: *rng (stream to draw from)
+* - Output: double (random number)
+*******************************************************************************/
+static inline double rngUniform(Rng *rng)
+{
+    return ((double)(rngNext(rng) >> 11) + 0.5) * 0x1.0p-53;
+}
+
+/*******************************************************************************
+*       rngBelow(Rng *rng, uint32_t n)
+********************************************************************************
+* Function to generate an unbiased integer in [0, n) (Lemire's method)
+* - Input: *rng (stream to draw from)
+*           n (number of possible values, > 0)
+* - Output: uint32_t (random integer)
+*******************************************************************************/
+static inline uint32_t rngBelow(Rng *rng, uint32_t n)
+{
+    uint64_t m = (rngNext(rng) >> 32) * (uint64_t)n;
+    uint32_t low = (uint32_t)m;
+
+    if (low < n)
+    {
+        uint32_t threshold = -n % n;
+        while (low < threshold)
+        {
+            m = (rngNext(rng) >> 32) * (uint64_t)n;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+/*******************************************************************************
+*       rngSeed(Rng *rng, uint64_t seed)
+********************************************************************************
+* Function that initializes a stream from a 64-bit seed (expanded with
+* splitmix64, as recommended by the authors of xoshiro)
+* - Input: *rng (stream to initialize)
+*           seed (any value, including 0)
+*******************************************************************************/
+void rngSeed(Rng *rng, uint64_t seed)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        rng->s[i] = z ^ (z >> 31);
+    }
+}
+
+/*******************************************************************************
+*       rngAdvance(Rng *rng, const uint64_t poly[4])
+********************************************************************************
+* Function that moves a stream ahead by the distance encoded in poly
+* - Input: *rng (stream to move)
+*           poly (jump polynomial)
+*******************************************************************************/
+void rngAdvance(Rng *rng, const uint64_t poly[4])
+{
+    uint64_t s[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            if (poly[i] & (1ULL << b))
+            {
+                s[0] ^= rng->s[0];
+                s[1] ^= rng->s[1];
+                s[2] ^= rng->s[2];
+                s[3] ^= rng->s[3];
+            }
+            rngNext(rng);
+        }
+    }
+    for (int i = 0; i < 4; i++)
+        rng->s[i] = s[i];
+}
+
+/*******************************************************************************
+*       rngJump(Rng *rng) / rngLongJump(Rng *rng)
+********************************************************************************
+* Functions that move a stream 2^128 (resp. 2^192) draws ahead
+* - Input: *rng (stream to move)
+*******************************************************************************/
+void rngJump(Rng *rng)
+{
+    static const uint64_t poly[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    rngAdvance(rng, poly);
+}
+
+void rngLongJump(Rng *rng)
+{
+    static const uint64_t poly[4] = {
+        0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+        0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+    rngAdvance(rng, poly);
+}
+
+/*******************************************************************************
+*       rngStreams(Rng streams[], uint64_t seed, int rep)
+********************************************************************************
+* Function that initializes the NUM_STREAMS streams of replication rep of a
+* simulation from its master seed. Replication rep starts rep long jumps
+* (2^192 draws) after replication 0, so replications never overlap either.
+* - Input: streams (array of NUM_STREAMS streams)
+*           seed (master seed)
+*           rep (index of the replication, 0 for a single run)
+*******************************************************************************/
+void rngStreams(Rng streams[], uint64_t seed, int rep)
+{
+    rngSeed(&streams[0], seed);
+    for (int r = 0; r < rep; r++)
+        rngLongJump(&streams[0]);
+    for (int i = 1; i < NUM_STREAMS; i++)
+    {
+        streams[i] = streams[i - 1];
+        rngJump(&streams[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,229 @@
+/*******************************************************************************
+*                       Service Time Distributions
+********************************************************************************
+* Notes: Draws the service times of a run from a distribution chosen with -G,
+* always with the mean given to -d (the shape is the only free parameter):
+*   exp             exponential (default, the Markovian models)
+*   det             deterministic, every job takes the mean
+*   erlang:k        Erlang with k phases (SCV 1/k)
+*   hyper:scv       two-phase hyperexponential with balanced means and this
+*                   squared coefficient of variation (>= 1)
+*   lognormal:cv    lognormal with this coefficient of variation
+*   pareto:alpha    Pareto with this tail index (> 1, heavy-tailed)
+*   weibull:k       Weibull with this shape (< 1 heavy, > 1 light tail)
+* A Sampler computes the parameters of its distribution once, then fills a
+* block of SAMPLER_BLOCK variates at a time with a loop specialized to the
+* distribution, like ExpStream for the exponential; the exponential draws
+* exactly the variates of expntl(), so -G exp runs are unchanged.
+*------------------------------------------------------------------------------*
+* Usage:
+*   Distr d;
+*   Sampler s;
+*   parseDistr("pareto:2.5", &d);
+*   samplerInit(&s, &d, mean, &streams[STREAM_SERVICE]);
+*   service = sampleNext(&s);
+*******************************************************************************/
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdio.h>              // Needed for snprintf()
+#include <stdlib.h>             // Needed for strtod()
+#include <string.h>             // Needed for strncmp(), strlen() and memset()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for exp(), log(), sqrt(), tgamma() and isfinite()
+#include "rng.h"                // Needed for Rng and rngUniform()
+#include "utils.h"              // Needed for expUnit()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define SAMPLER_BLOCK  EXP_BLOCK    // Variates generated per refill
+
+enum {                          // Service time distributions
+    DISTR_EXP,
+    DISTR_DET,
+    DISTR_ERLANG,
+    DISTR_HYPER,
+    DISTR_LOGNORMAL,
+    DISTR_PARETO,
+    DISTR_WEIBULL,
+    NUM_DISTRS
+};
+
+static const char *distrNames[NUM_DISTRS] = {
+    "exp", "det", "erlang", "hyper", "lognormal", "pareto", "weibull" };
+
+typedef struct Distr {          // Distribution chosen on the command line
+    int type;                   // DISTR_*
+    double shape;               // Its parameter (see the notes above)
+    char name[32];              // As given to -G, e.g. "pareto:2.5"
+} Distr;
+
+typedef struct Sampler {        // Block of service times of one distribution
+    int type;                   // DISTR_*
+    Rng *rng;                   // Random stream the block is drawn from
+    double a, b, p;             // Parameters, precomputed by samplerInit()
+    int k;                      // Phases of the Erlang
+    unsigned int next;          // Next unused variate in v[]
+    double v[SAMPLER_BLOCK];
+} Sampler;
+
+/*******************************************************************************
+*       parseDistr(const char *arg, Distr *d)
+********************************************************************************
+* Function that parses a distribution "name" or "name:shape"
+* - Input: arg (distribution, see the notes above)
+* - Output: *d (parsed distribution)
+*           bool (false if the name is unknown or the shape is invalid)
+*******************************************************************************/
+bool parseDistr(const char *arg, Distr *d)
+{
+    const char *colon = strchr(arg, ':');
+    size_t len = colon ? (size_t)(colon - arg) : strlen(arg);
+    char *end;
+
+    memset(d, 0, sizeof(*d));   // Compared bytewise by the checkpoints
+    d->type = -1;
+    for (int i = 0; i < NUM_DISTRS; i++)
+        if (strlen(distrNames[i]) == len && strncmp(arg, distrNames[i], len) == 0)
+            d->type = i;
+    if (d->type < 0)
+        return false;
+    if (colon)
+    {
+        d->shape = strtod(colon + 1, &end);
+        if (end == colon + 1 || *end != '\0' || !isfinite(d->shape))
+            return false;
+    }
+    snprintf(d->name, sizeof(d->name), "%s", arg);
+
+    switch (d->type) {
+        case DISTR_EXP:
+        case DISTR_DET:
+            return colon == NULL;
+        case DISTR_ERLANG:
+            return d->shape >= 1 && d->shape == floor(d->shape);
+        case DISTR_HYPER:
+            return d->shape >= 1;
+        case DISTR_LOGNORMAL:
+        case DISTR_WEIBULL:
+            return d->shape > 0;
+        case DISTR_PARETO:
+            return d->shape > 1;    // Finite mean
+    }
+    return false;
+}
+
+/*******************************************************************************
+*       samplerInit(Sampler *s, const Distr *d, double mean, Rng *rng)
+********************************************************************************
+* Function that computes the parameters of a distribution with the given mean
+* - Input: *s (sampler to initialize)
+*           *d (distribution)
+*           mean (mean service time)
+*           *rng (random stream to draw from, must outlive s)
+*******************************************************************************/
+void samplerInit(Sampler *s, const Distr *d, double mean, Rng *rng)
+{
+    s->type = d->type;
+    s->rng = rng;
+    s->next = SAMPLER_BLOCK;    // Filled on the first draw
+    s->a = mean;
+    s->b = 0.0;
+    s->p = 0.0;
+    s->k = 1;
+
+    switch (d->type) {
+        case DISTR_ERLANG:      // Sum of k exponentials of mean mean/k
+            s->k = (int)d->shape;
+            s->a = mean / s->k;
+            break;
+        case DISTR_HYPER:       // Phase 1 with probability p, p*mean1 = (1-p)*mean2
+            s->p = 0.5 * (1.0 + sqrt((d->shape - 1.0) / (d->shape + 1.0)));
+            s->a = mean / (2.0 * s->p);
+            s->b = mean / (2.0 * (1.0 - s->p));
+            break;
+        case DISTR_LOGNORMAL:   // exp(a + b N(0,1))
+            s->b = sqrt(log(1.0 + d->shape * d->shape));
+            s->a = log(mean) - 0.5 * s->b * s->b;
+            break;
+        case DISTR_PARETO:      // a u^(-1/alpha) = a exp(E / alpha)
+            s->a = mean * (d->shape - 1.0) / d->shape;
+            s->b = 1.0 / d->shape;
+            break;
+        case DISTR_WEIBULL:     // a E^(1/k)
+            s->a = mean / tgamma(1.0 + 1.0 / d->shape);
+            s->b = 1.0 / d->shape;
+            break;
+    }
+}
+
+/*******************************************************************************
+*       samplerFill(Sampler *s)
+********************************************************************************
+* Function that refills the block of a sampler with SAMPLER_BLOCK variates
+* - Input: *s (sampler to refill)
+*******************************************************************************/
+void samplerFill(Sampler *s)
+{
+    Rng *rng = s->rng;
+    double *v = s->v;
+
+    switch (s->type) {
+        case DISTR_EXP:
+            for (int i = 0; i < SAMPLER_BLOCK; i++)
+                v[i] = s->a * expUnit(rng);
+            break;
+        case DISTR_DET:
+            for (int i = 0; i < SAMPLER_BLOCK; i++)
+                v[i] = s->a;
+            break;
+        case DISTR_ERLANG:
+            for (int i = 0; i < SAMPLER_BLOCK; i++)
+            {
+                double sum = 0.0;
+                for (int j = 0; j < s->k; j++)
+                    sum += expUnit(rng);
+                v[i] = s->a * sum;
+            }
+            break;
+        case DISTR_HYPER:
+            for (int i = 0; i < SAMPLER_BLOCK; i++)
+                v[i] = ((rngUniform(rng) < s->p) ? s->a : s->b) * expUnit(rng);
+            break;
+        case DISTR_LOGNORMAL:   // Box-Muller, two normals per pair of uniforms
+            for (int i = 0; i < SAMPLER_BLOCK; i += 2)
+            {
+                double r = sqrt(-2.0 * log(rngUniform(rng)));
+                double angle = 2.0 * M_PI * rngUniform(rng);
+                v[i] = exp(s->a + s->b * r * cos(angle));
+                v[i + 1] = exp(s->a + s->b * r * sin(angle));
+            }
+            break;
+        case DISTR_PARETO:
+            for (int i = 0; i < SAMPLER_BLOCK; i++)
+                v[i] = s->a * exp(s->b * expUnit(rng));
+            break;
+        case DISTR_WEIBULL:
+            for (int i = 0; i < SAMPLER_BLOCK; i++)
+                v[i] = s->a * pow(expUnit(rng), s->b);
+            break;
+    }
+    s->next = 0;
+}
+
+/*******************************************************************************
+*       sampleNext(Sampler *s)
+********************************************************************************
+* Function that returns the next service time of a sampler
+* - Input: *s (sampler to draw from)
+* - Output: double (service time)
+*******************************************************************************/
+static inline double sampleNext(Sampler *s)
+{
+    if (s->next == SAMPLER_BLOCK)
+        samplerFill(s);
+    return s->v[s->next++];
+}
+
+#endif
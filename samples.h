@@ -0,0 +1,149 @@
+/*******************************************************************************
+*                         Arena-backed Sample Buffers
+********************************************************************************
+* Notes: Append-only store for the per-event samples the simulators collect
+* (interarrival times, service times, idle/busy periods, ...). Samples are
+* written contiguously into fixed-size chunks, and chunks are carved out of
+* large slabs owned by an Arena. A simulation run therefore does one malloc()
+* per ARENA_SLAB * SAMPLE_CHUNK samples instead of one per event, and every
+* buffer sharing the arena is released at once with arenaFree().
+*------------------------------------------------------------------------------*
+* Usage:
+*   Arena arena = {0};
+*   SampleBuf idle;
+*   sampleInit(&idle, &arena);
+*   sampleAdd(&idle, value);
+*   forEachSample(&idle, chunk, i)
+*       printf("%f\n", chunk->values[i]);
+*   arenaFree(&arena);
+*******************************************************************************/
+#ifndef SAMPLES_H
+#define SAMPLES_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for malloc() and exit()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define SAMPLE_CHUNK   1024     // Samples stored per chunk (8 KiB)
+#define ARENA_SLAB     64       // Chunks allocated per arena slab (512 KiB)
+#ifndef KEEP_SAMPLES
+#define KEEP_SAMPLES   0        // Build with -DKEEP_SAMPLES=1 to keep the raw
+#endif                          // samples used by the printList() debug dumps
+
+typedef struct Chunk {          // Contiguous block of samples
+    struct Chunk *next;         // Next (newer) chunk of the same buffer
+    unsigned int count;         // Number of used entries in values[]
+    double values[SAMPLE_CHUNK];
+} Chunk;
+
+typedef struct Slab {           // Unit of allocation of the arena
+    struct Slab *next;
+    Chunk chunks[ARENA_SLAB];
+} Slab;
+
+typedef struct Arena {          // Owner of every chunk handed to the buffers
+    Slab *slabs;                // List of allocated slabs (newest first)
+    unsigned int used;          // Chunks already handed out from slabs
+} Arena;
+
+typedef struct SampleBuf {      // Append-only sample store (oldest first)
+    Arena *arena;
+    Chunk *head;
+    Chunk *tail;
+    unsigned long count;        // Total number of samples stored
+} SampleBuf;
+
+// Iterate over every sample of a buffer in insertion order. The sample is
+// chunk->values[i] inside the loop body.
+#define forEachSample(buf, chunk, i)                                    \
+    for (Chunk *chunk = (buf)->head; chunk != NULL; chunk = chunk->next) \
+        for (unsigned int i = 0; i < chunk->count; i++)
+
+/*******************************************************************************
+*       arenaChunk(Arena *arena)
+********************************************************************************
+* Function that hands out an empty chunk, allocating a new slab when the
+* current one is exhausted
+* - Input: *arena (arena that owns the chunk)
+* - Output: Chunk* (empty chunk)
+*******************************************************************************/
+Chunk* arenaChunk(Arena *arena)
+{
+    if (arena->slabs == NULL || arena->used == ARENA_SLAB)
+    {
+        Slab *slab = (Slab*)malloc(sizeof(Slab));
+        if (!slab) {
+            printf("Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        slab->next = arena->slabs;
+        arena->slabs = slab;
+        arena->used = 0;
+    }
+
+    Chunk *chunk = &arena->slabs->chunks[arena->used++];
+    chunk->next = NULL;
+    chunk->count = 0;
+    return chunk;
+}
+
+/*******************************************************************************
+*       arenaFree(Arena *arena)
+********************************************************************************
+* Function that releases every slab of the arena (and with them the content of
+* every buffer that used it)
+* - Input: *arena (arena to release)
+*******************************************************************************/
+void arenaFree(Arena *arena)
+{
+    Slab *temp;
+    while (arena->slabs) {
+        temp = arena->slabs;
+        arena->slabs = temp->next;
+        free(temp);
+    }
+    arena->used = 0;
+}
+
+/*******************************************************************************
+*       sampleInit(SampleBuf *buf, Arena *arena)
+********************************************************************************
+* Function that initializes an empty sample buffer backed by an arena
+* - Input: *buf (buffer to initialize)
+*           *arena (arena providing the memory)
+*******************************************************************************/
+void sampleInit(SampleBuf *buf, Arena *arena)
+{
+    buf->arena = arena;
+    buf->head = NULL;
+    buf->tail = NULL;
+    buf->count = 0;
+}
+
+/*******************************************************************************
+*       sampleAdd(SampleBuf *buf, double value)
+********************************************************************************
+* Function that appends a sample at the end of the buffer
+* - Input: *buf (buffer to append to)
+*           value (sample to store)
+*******************************************************************************/
+void sampleAdd(SampleBuf *buf, double value)
+{
+    Chunk *tail = buf->tail;
+
+    if (tail == NULL || tail->count == SAMPLE_CHUNK)
+    {
+        Chunk *chunk = arenaChunk(buf->arena);
+        if (tail == NULL)
+            buf->head = chunk;
+        else
+            tail->next = chunk;
+        buf->tail = tail = chunk;
+    }
+    tail->values[tail->count++] = value;
+    buf->count++;
+}
+
+#endif
@@ -0,0 +1,230 @@
+/*******************************************************************************
+*                            Parameter Sweeps
+********************************************************************************
+* Notes: Runs a grid of simulation points (every combination of the values
+* given to -a, -d, -c, -k) in one process. Every (point, replication) pair is a
+* job of the replication pool; points are queued by decreasing load, so the
+* long, highly loaded points start first and the short ones fill the gaps at
+* the end. A point is summarized as soon as its last replication completes,
+* and the rows are written in grid order, one per point in a single table:
+* each as soon as it and every point before it are done.
+*------------------------------------------------------------------------------*
+* Values of an axis:
+*   x               a single value
+*   x1,x2,...,xn    a list of values
+*   min:max:step    every value from min to max (included) by step
+*******************************************************************************/
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>              // Needed for FILE and printf()
+#include <stdlib.h>             // Needed for malloc(), strtod() and qsort()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for floor()
+#include <pthread.h>            // Needed for pthread_mutex_t
+#include "replicate.h"          // Needed for runReplications()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define MAX_AXIS       1024     // Maximum number of values of an axis
+
+typedef struct Axis {           // Values taken by one parameter
+    int n;
+    double at[MAX_AXIS];
+} Axis;
+
+typedef struct Sweep {          // Grid of points run on the pool
+    int points;                 // Number of points of the grid
+    int reps;                   // Replications of each point
+    int *order;                 // Points by decreasing load
+    int *started;               // Replications started, per point
+    int *done;                  // Replications completed, per point
+    int written;                // Points written, in grid order
+    pthread_mutex_t lock;       // Protects started[], done[], written and the callbacks
+    void *ctx;                  // Argument passed to the callbacks
+    void (*begin)(void *ctx, int point);                // Before the 1st replication
+    void (*run)(void *ctx, int point, int rep);         // Runs one replication
+    void (*end)(void *ctx, int point);                  // After the last replication
+    void (*write)(void *ctx, int point);                // Writes the row of a point
+} Sweep;
+
+typedef struct SweepLoad {      // Sort key of a point
+    double load;
+    int point;
+} SweepLoad;
+
+/*******************************************************************************
+*       parseAxis(const char *arg, Axis *axis)
+********************************************************************************
+* Function that parses the values of an axis (see the notes above)
+* - Input: arg (value of the command line option)
+* - Output: *axis (parsed values)
+*           bool (false if arg is malformed or has too many values)
+*******************************************************************************/
+bool parseAxis(const char *arg, Axis *axis)
+{
+    char *end;
+    double first = strtod(arg, &end);
+
+    if (end == arg)
+        return false;
+    if (*end == ':')
+    {
+        double max = strtod(end + 1, &end);
+        double step;
+        if (*end != ':')
+            return false;
+        step = strtod(end + 1, &end);
+        if (*end != '\0' || step <= 0 || max < first)
+            return false;
+        int n = (int)floor((max - first) / step + 1e-9) + 1;
+        if (n > MAX_AXIS)
+            return false;
+        for (int i = 0; i < n; i++)
+            axis->at[i] = first + i * step;
+        axis->n = n;
+        return true;
+    }
+
+    axis->n = 0;
+    axis->at[axis->n++] = first;
+    while (*end == ',')
+    {
+        const char *next = end + 1;
+        double value = strtod(next, &end);
+        if (end == next || axis->n == MAX_AXIS)
+            return false;
+        axis->at[axis->n++] = value;
+    }
+    return *end == '\0';
+}
+
+/*******************************************************************************
+*       axisAbove(const Axis *axis, double min, bool integer)
+********************************************************************************
+* Function that checks the values of an axis
+* - Input: *axis (parsed values)
+*           min (every value must be greater)
+*           integer (every value must be an integer)
+* - Output: bool (false if a value is not)
+*******************************************************************************/
+bool axisAbove(const Axis *axis, double min, bool integer)
+{
+    for (int i = 0; i < axis->n; i++)
+        if (axis->at[i] <= min || (integer && axis->at[i] != floor(axis->at[i])))
+            return false;
+    return true;
+}
+
+/*******************************************************************************
+*       sweepCompare(const void *a, const void *b)
+********************************************************************************
+* qsort() comparator: decreasing load, then increasing point index
+*******************************************************************************/
+int sweepCompare(const void *a, const void *b)
+{
+    const SweepLoad *x = (const SweepLoad*)a;
+    const SweepLoad *y = (const SweepLoad*)b;
+
+    if (x->load != y->load)
+        return (x->load < y->load) ? 1 : -1;
+    return x->point - y->point;
+}
+
+/*******************************************************************************
+*       sweepInit(Sweep *sw, int points, int reps, const double load[])
+********************************************************************************
+* Function that prepares the run of a grid. The callbacks and ctx are set
+* by the caller.
+* - Input: *sw (sweep to initialize)
+*           points (number of points)
+*           reps (replications of each point)
+*           load (expected load of each point, e.g. the utilization)
+*******************************************************************************/
+void sweepInit(Sweep *sw, int points, int reps, const double load[])
+{
+    SweepLoad *keys = (SweepLoad*)malloc(points * sizeof(SweepLoad));
+
+    sw->points = points;
+    sw->reps = reps;
+    sw->written = 0;
+    sw->order = (int*)malloc(points * sizeof(int));
+    sw->started = (int*)calloc(points, sizeof(int));
+    sw->done = (int*)calloc(points, sizeof(int));
+    if (!keys || !sw->order || !sw->started || !sw->done) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&sw->lock, NULL);
+
+    for (int i = 0; i < points; i++)
+    {
+        keys[i].load = load[i];
+        keys[i].point = i;
+    }
+    qsort(keys, points, sizeof(SweepLoad), sweepCompare);
+    for (int i = 0; i < points; i++)
+        sw->order[i] = keys[i].point;
+    free(keys);
+}
+
+/*******************************************************************************
+*       sweepJob(void *arg, int job)
+********************************************************************************
+* Function run by the pool for each job: replication job % reps of the
+* (job / reps)-th point by decreasing load. The job that completes a point
+* ends it, then writes the points now complete in grid order.
+* - Input: arg (Sweep being run)
+*           job (index of the job)
+*******************************************************************************/
+void sweepJob(void *arg, int job)
+{
+    Sweep *sw = (Sweep*)arg;
+    int point = sw->order[job / sw->reps];
+    int rep = job % sw->reps;
+
+    pthread_mutex_lock(&sw->lock);
+    if (sw->started[point]++ == 0)
+        sw->begin(sw->ctx, point);
+    pthread_mutex_unlock(&sw->lock);
+
+    sw->run(sw->ctx, point, rep);
+
+    pthread_mutex_lock(&sw->lock);
+    if (++sw->done[point] == sw->reps)
+    {
+        sw->end(sw->ctx, point);
+        while (sw->written < sw->points && sw->done[sw->written] == sw->reps)
+            sw->write(sw->ctx, sw->written++);
+    }
+    pthread_mutex_unlock(&sw->lock);
+}
+
+/*******************************************************************************
+*       runSweep(Sweep *sw, int threads)
+********************************************************************************
+* Function that runs every replication of every point of the grid
+* - Input: *sw (initialized sweep)
+*           threads (maximum number of threads)
+*******************************************************************************/
+void runSweep(Sweep *sw, int threads)
+{
+    runReplications(sweepJob, sw, sw->points * sw->reps, threads);
+}
+
+/*******************************************************************************
+*       sweepFree(Sweep *sw)
+********************************************************************************
+* Function that releases the memory of a sweep
+* - Input: *sw (sweep to release)
+*******************************************************************************/
+void sweepFree(Sweep *sw)
+{
+    free(sw->order);
+    free(sw->started);
+    free(sw->done);
+    pthread_mutex_destroy(&sw->lock);
+}
+
+#endif
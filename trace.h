@@ -0,0 +1,177 @@
+/*******************************************************************************
+*                             Event Trace Recorder
+********************************************************************************
+* Notes: Optional log of every event of a run (-t file), written as fixed-size
+* records straight into a memory-mapped file. The file is preallocated
+* (TRACE_PREALLOC records, sparse until written) and doubles when full, so
+* recording an event is a store and an increment, with no system call and no
+* formatting. trace2json.c converts a trace to Chrome/Perfetto JSON.
+*
+* A job is identified by its arrival time (every event of a job carries it),
+* which is unique within a run and needs no bookkeeping in the queues.
+*------------------------------------------------------------------------------*
+* Layout (native byte order, little endian on x86):
+*   TraceHeader               magic "QSIMTRC1", record size, number of
+*                             servers, seconds per unit of time, records
+*   TraceRecord[records]      events in the order they happened
+*------------------------------------------------------------------------------*
+* Usage:
+*   Trace tr;
+*   traceOpen(&tr, "run.trace", c, TIME_UNIT);
+*   traceAdd(&tr, TRACE_ARRIVAL, time, TRACE_NONE, time);
+*   traceClose(&tr);
+*******************************************************************************/
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdlib.h>             // Needed for exit()
+#include <string.h>             // Needed for memcpy()
+#include <stdint.h>             // Needed for uint32_t and uint64_t
+#include <fcntl.h>              // Needed for open()
+#include <unistd.h>             // Needed for ftruncate() and close()
+#include <sys/mman.h>           // Needed for mmap() and munmap()
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define TRACE_MAGIC    "QSIMTRC1"
+#define TRACE_PREALLOC (1 << 20)    // Records preallocated in the file
+#define TRACE_NONE     0xffffffffu  // Server of an event that has none
+
+enum {                          // Types of event
+    TRACE_ARRIVAL,              // Job arrives (server: none)
+    TRACE_DROP,                 // Job lost, the system is full (server: none)
+    TRACE_DISPATCH,             // Job assigned to a server
+    TRACE_SERVICE_START,        // Server starts serving the job
+    TRACE_DEPARTURE,            // Job leaves the server
+    TRACE_CORE_IDLE_ENTER,      // Server becomes idle (job: none)
+    TRACE_CORE_IDLE_EXIT,       // Server leaves idle (job: none)
+    TRACE_PKG_IDLE_ENTER,       // Every server idle (server, job: none)
+    TRACE_PKG_IDLE_EXIT,        // One server leaves the package idle
+    NUM_TRACE_EVENTS
+};
+
+typedef struct TraceHeader {    // First bytes of a trace file
+    char magic[8];              // TRACE_MAGIC
+    uint32_t recordSize;        // sizeof(TraceRecord)
+    uint32_t servers;           // Number of servers of the run
+    double timeUnit;            // Seconds per unit of time
+    uint64_t records;           // Number of records that follow
+} TraceHeader;
+
+typedef struct TraceRecord {    // One event (24 bytes)
+    double time;                // Time of the event
+    double job;                 // Arrival time of the job (-1 if none)
+    uint32_t server;            // Server of the event (TRACE_NONE if none)
+    uint32_t type;              // TRACE_*
+} TraceRecord;
+
+typedef struct Trace {          // Trace being written
+    int fd;                     // Trace file
+    TraceHeader *header;        // Mapping of the whole file
+    TraceRecord *records;       // Records of the mapping
+    uint64_t count;             // Records written
+    uint64_t capacity;          // Records the file can hold
+} Trace;
+
+/*******************************************************************************
+*       traceMap(Trace *tr, uint64_t capacity)
+********************************************************************************
+* Function that resizes the trace file to capacity records and maps it
+* - Input: *tr (trace)
+*           capacity (records the file must hold)
+*******************************************************************************/
+void traceMap(Trace *tr, uint64_t capacity)
+{
+    size_t bytes = sizeof(TraceHeader) + capacity * sizeof(TraceRecord);
+
+    if (ftruncate(tr->fd, bytes) != 0) {
+        printf("Cannot grow the trace file!\n");
+        exit(EXIT_FAILURE);
+    }
+    void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, tr->fd, 0);
+    if (map == MAP_FAILED) {
+        printf("Cannot map the trace file!\n");
+        exit(EXIT_FAILURE);
+    }
+    tr->header = (TraceHeader*)map;
+    tr->records = (TraceRecord*)(tr->header + 1);
+    tr->capacity = capacity;
+}
+
+/*******************************************************************************
+*       traceOpen(Trace *tr, const char *path, int servers, double timeUnit)
+********************************************************************************
+* Function that creates a trace file and preallocates TRACE_PREALLOC records
+* - Input: *tr (trace to open)
+*           path (file to create)
+*           servers (number of servers of the run)
+*           timeUnit (seconds per unit of time)
+*******************************************************************************/
+void traceOpen(Trace *tr, const char *path, int servers, double timeUnit)
+{
+    tr->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (tr->fd < 0) {
+        printf("Cannot open %s!\n", path);
+        exit(EXIT_FAILURE);
+    }
+    traceMap(tr, TRACE_PREALLOC);
+    memcpy(tr->header->magic, TRACE_MAGIC, 8);
+    tr->header->recordSize = sizeof(TraceRecord);
+    tr->header->servers = servers;
+    tr->header->timeUnit = timeUnit;
+    tr->header->records = 0;
+    tr->count = 0;
+}
+
+/*******************************************************************************
+*       traceGrow(Trace *tr)
+********************************************************************************
+* Function that doubles the capacity of a full trace file
+* - Input: *tr (trace)
+*******************************************************************************/
+void traceGrow(Trace *tr)
+{
+    munmap(tr->header, sizeof(TraceHeader) + tr->capacity * sizeof(TraceRecord));
+    traceMap(tr, 2 * tr->capacity);
+}
+
+/*******************************************************************************
+*       traceAdd(Trace *tr, int type, double time, uint32_t server, double job)
+********************************************************************************
+* Function that records one event
+* - Input: *tr (trace)
+*           type (TRACE_*)
+*           time (time of the event)
+*           server (server of the event, TRACE_NONE if none)
+*           job (arrival time of the job, -1 if none)
+*******************************************************************************/
+static inline void traceAdd(Trace *tr, int type, double time, uint32_t server, double job)
+{
+    if (tr->count == tr->capacity)
+        traceGrow(tr);
+    TraceRecord *r = &tr->records[tr->count++];
+    r->time = time;
+    r->job = job;
+    r->server = server;
+    r->type = type;
+}
+
+/*******************************************************************************
+*       traceClose(Trace *tr)
+********************************************************************************
+* Function that writes the number of records, trims the file to them and
+* closes it
+* - Input: *tr (trace to close)
+*******************************************************************************/
+void traceClose(Trace *tr)
+{
+    tr->header->records = tr->count;
+    munmap(tr->header, sizeof(TraceHeader) + tr->capacity * sizeof(TraceRecord));
+    if (ftruncate(tr->fd, sizeof(TraceHeader) + tr->count * sizeof(TraceRecord)) != 0)
+        printf("Cannot trim the trace file!\n");
+    close(tr->fd);
+}
+
+#endif
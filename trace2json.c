@@ -0,0 +1,269 @@
+/*******************************************************************************
+*                    Event Trace to Chrome/Perfetto JSON
+********************************************************************************
+* Notes: Converts a trace written by a simulator (-t, see trace.h) to the
+* Chrome trace event format, which ui.perfetto.dev and chrome://tracing open.
+* Every server is a thread with its "idle" and "job" slices (so the idle gaps
+* of each core are visible), plus an "arrivals" thread with the arrivals and
+* drops and a "package" thread with the package idle periods. Jobs are named
+* by their arrival time (in us). With a window (-b, -e), the slices already
+* in progress at its start begin there, and the slices still open at its end
+* (or at the last event of the run) end there, so every slice is complete.
+*------------------------------------------------------------------------------*
+* Build Command:
+* gcc -o trace2json trace2json.c
+*------------------------------------------------------------------------------*
+* Execute command:
+* ./mmc -t run.trace && ./trace2json run.trace run.json
+*******************************************************************************/
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdio.h>              // Needed for printf() and fprintf()
+#include <stdlib.h>             // Needed for atof(), malloc() and exit()
+#include <string.h>             // Needed for memcmp()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for INFINITY
+#include <fcntl.h>              // Needed for open()
+#include <unistd.h>             // Needed for getopt() and close()
+#include <sys/mman.h>           // Needed for mmap()
+#include <sys/stat.h>           // Needed for fstat()
+#include "trace.h"              // Needed for TraceHeader and TraceRecord
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void show_usage(char *name);
+void writeEvent(FILE *out, const char *name, char ph, double ts, uint32_t tid, double job);
+void writeSlices(FILE *out, char ph, double ts, uint32_t servers, const double jobOpen[],
+                 const bool idleOpen[], bool pkgOpen);
+
+/*******************************************************************************
+* Main Function
+*******************************************************************************/
+int main(int argc, char **argv)
+{
+    double begin = -INFINITY;   // Start of the converted window (sec)
+    double end = INFINITY;      // End of the converted window (sec)
+    int opt;                    // Hold the options passed as argument
+
+    while ( (opt = getopt(argc, argv, "b:e:")) != -1 )
+    {
+        switch (opt) {
+            case 'b':
+                begin = atof(optarg);
+                break;
+            case 'e':
+                end = atof(optarg);
+                break;
+            default:    // '?' unknown option
+                show_usage( argv[0] );
+        }
+    }
+    if (optind >= argc)
+        show_usage( argv[0] );
+
+    // Map the trace
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TraceHeader)) {
+        printf("Cannot open %s!\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+    const TraceHeader *header = (const TraceHeader*)mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (header == MAP_FAILED || memcmp(header->magic, TRACE_MAGIC, 8) != 0
+        || header->recordSize != sizeof(TraceRecord)
+        || sizeof(TraceHeader) + header->records * sizeof(TraceRecord) > (size_t)info.st_size) {
+        printf("%s is not a trace!\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+    const TraceRecord *rec = (const TraceRecord*)(header + 1);
+    uint32_t servers = header->servers;
+    double scale = header->timeUnit * 1e6;  // Unit of the trace to us
+
+    FILE *out = (optind + 1 < argc) ? fopen(argv[optind + 1], "w") : stdout;
+    if (!out) {
+        printf("Cannot open %s!\n", argv[optind + 1]);
+        exit(EXIT_FAILURE);
+    }
+
+    // Names of the threads
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"queue\"}}");
+    for (uint32_t i = 0; i < servers; i++)
+        fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"server %u\"}}", i, i);
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"arrivals\"}}", servers);
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"package\"}}", servers + 1);
+
+    // Slices in progress: job of each server (its arrival in us, -1 if none),
+    // idle servers and idle package
+    double *jobOpen = (double*)malloc(servers * sizeof(double));
+    bool *idleOpen = (bool*)calloc(servers, sizeof(bool));
+    bool pkgOpen = false;
+    bool opened = false;        // Slices in progress at begin written
+    bool cut = false;           // Window ended before the run
+    double last = begin * 1e6;  // End of the window (us)
+    if (!jobOpen || !idleOpen) {
+        printf("Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < servers; i++)
+        jobOpen[i] = -1;
+
+    // Events of the window
+    for (uint64_t i = 0; i < header->records; i++)
+    {
+        const TraceRecord *r = &rec[i];
+        double sec = r->time * header->timeUnit;
+        double ts = r->time * scale;
+        double job = r->job * scale;
+        bool server = (r->server < servers);
+
+        if (sec > end)
+        {
+            last = end * 1e6;
+            cut = true;
+            break;
+        }
+        if (sec >= begin && !opened)
+        {
+            writeSlices(out, 'B', begin * 1e6, servers, jobOpen, idleOpen, pkgOpen);
+            opened = true;
+        }
+        switch (r->type) {      // Slices in progress after the event
+            case TRACE_SERVICE_START:
+                if (server)
+                    jobOpen[r->server] = job;
+                break;
+            case TRACE_DEPARTURE:
+                if (server)
+                    jobOpen[r->server] = -1;
+                break;
+            case TRACE_CORE_IDLE_ENTER:
+            case TRACE_CORE_IDLE_EXIT:
+                if (server)
+                    idleOpen[r->server] = (r->type == TRACE_CORE_IDLE_ENTER);
+                break;
+            case TRACE_PKG_IDLE_ENTER:
+            case TRACE_PKG_IDLE_EXIT:
+                pkgOpen = (r->type == TRACE_PKG_IDLE_ENTER);
+                break;
+        }
+        if (sec < begin)
+            continue;
+        last = ts;
+        switch (r->type) {
+            case TRACE_ARRIVAL:
+                writeEvent(out, "arrival", 'i', ts, servers, job);
+                break;
+            case TRACE_DROP:
+                writeEvent(out, "drop", 'i', ts, servers, job);
+                break;
+            case TRACE_DISPATCH:
+                writeEvent(out, "dispatch", 'i', ts, r->server, job);
+                break;
+            case TRACE_SERVICE_START:
+                writeEvent(out, "job", 'B', ts, r->server, job);
+                break;
+            case TRACE_DEPARTURE:
+                writeEvent(out, "job", 'E', ts, r->server, job);
+                break;
+            case TRACE_CORE_IDLE_ENTER:
+                writeEvent(out, "idle", 'B', ts, r->server, -1);
+                break;
+            case TRACE_CORE_IDLE_EXIT:
+                writeEvent(out, "idle", 'E', ts, r->server, -1);
+                break;
+            case TRACE_PKG_IDLE_ENTER:
+                writeEvent(out, "package idle", 'B', ts, servers + 1, -1);
+                break;
+            case TRACE_PKG_IDLE_EXIT:
+                writeEvent(out, "package idle", 'E', ts, servers + 1, -1);
+                break;
+        }
+    }
+    if (!opened && cut)         // No event in the window
+    {
+        writeSlices(out, 'B', begin * 1e6, servers, jobOpen, idleOpen, pkgOpen);
+        opened = true;
+    }
+    if (opened)
+        writeSlices(out, 'E', last, servers, jobOpen, idleOpen, pkgOpen);
+    fprintf(out, "\n]}\n");
+    free(jobOpen);
+    free(idleOpen);
+
+    if (out != stdout)
+        fclose(out);
+    munmap((void*)header, info.st_size);
+    close(fd);
+    return 0;
+}
+
+/*******************************************************************************
+*       show_usage(char *name)
+********************************************************************************
+* Function that return a message of how to use this program
+* - Input: name (the name of the executable)
+*******************************************************************************/
+static void show_usage(char *name)
+{
+    printf("\nUsage: \n");
+    printf("%s [option] value trace [output.json] \n", name);
+    printf("\n");
+    printf("Options: \n");
+    printf("\t-b\tFirst time converted (in seconds, default: start of the run)\n");
+    printf("\t-e\tLast time converted (in seconds, default: end of the run)\n");
+    exit(EXIT_SUCCESS);
+}
+
+/*******************************************************************************
+*       writeEvent(FILE *out, const char *name, char ph, double ts, uint32_t tid,
+*                  double job)
+********************************************************************************
+* Function that writes one event of the Chrome trace format
+* - Input: *out (JSON file)
+*           name (name of the slice or instant)
+*           ph (phase: 'B' begin, 'E' end, 'i' instant)
+*           ts (time of the event in us)
+*           tid (thread of the event)
+*           job (arrival time of the job in us, negative if none)
+*******************************************************************************/
+void writeEvent(FILE *out, const char *name, char ph, double ts, uint32_t tid, double job)
+{
+    fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u", name, ph, ts, tid);
+    if (ph == 'i')
+        fprintf(out, ",\"s\":\"t\"");
+    if (job >= 0)
+        fprintf(out, ",\"args\":{\"job\":%.3f}", job);
+    fprintf(out, "}");
+}
+
+/*******************************************************************************
+*       writeSlices(FILE *out, char ph, double ts, uint32_t servers,
+*                   const double jobOpen[], const bool idleOpen[], bool pkgOpen)
+********************************************************************************
+* Function that begins or ends every slice in progress at the edge of the
+* window
+* - Input: *out (JSON file)
+*           ph (phase: 'B' begin, 'E' end)
+*           ts (time of the edge in us)
+*           servers (number of servers)
+*           jobOpen (arrival of the job of each server in us, -1 if none)
+*           idleOpen (idle servers)
+*           pkgOpen (idle package)
+*******************************************************************************/
+void writeSlices(FILE *out, char ph, double ts, uint32_t servers, const double jobOpen[],
+                 const bool idleOpen[], bool pkgOpen)
+{
+    for (uint32_t i = 0; i < servers; i++)
+    {
+        if (jobOpen[i] >= 0)
+            writeEvent(out, "job", ph, ts, i, jobOpen[i]);
+        if (idleOpen[i])
+            writeEvent(out, "idle", ph, ts, i, -1);
+    }
+    if (pkgOpen)
+        writeEvent(out, "package idle", ph, ts, servers + 1, -1);
+}
@@ -1,89 +1,147 @@
-#include <math.h>               // Needed for log()
+#ifndef UTILS_H
+#define UTILS_H
+
+#include <math.h>               // Needed for log() and exp()
+#include "rng.h"                // Needed for Rng and rngNext()
 
 /*******************************************************************************
 * Defined constants and variables
 *******************************************************************************/
-#define CPU 8086                // Determines implementation of ranf to use
-
-// ranf() defines and variables. Extracted from course(EEE6462) material
-#define A 16807L 		    /* multiplier (7**5) for ’ranf’ */
-#define M 2147483647L 		/* modulus (2**31-1) for ’ranf’ */
+#define EXP_BLOCK      256      // Variates generated per refill of a stream
+#define ZIG_LAYERS     256      // Layers of the exponential ziggurat
+#define ZIG_R          7.697117470131487    // Start of the tail layer
+#define ZIG_V          3.949659822581572e-3 // Area of each layer
+//#define EXPNTL_EXACT          // Build with -DEXPNTL_EXACT to draw every
+                                // variate by inversion (-log(u)) instead of
+                                // the ziggurat, e.g. to compare runs exactly
 
-static long SeedTable[16]= {0L, /* seeds for streams 1 thru 15 */
-1973272912L, 747177549L, 20464843L, 640830765L, 1098742207L,
-78126602L, 84743774L, 831312807L, 124667236L, 1172177002L,
-1124933064L, 1223960546L, 1878892440L, 1449793615L, 553303732L};
+typedef struct ExpStream {      // Block of unit exponential variates
+    Rng *rng;                   // Random stream the block is drawn from
+    unsigned int next;          // Next unused variate in v[]
+    double v[EXP_BLOCK];
+} ExpStream;
 
-static int strm=1;          /* index of current stream */
+static uint64_t zigK[ZIG_LAYERS];   // Acceptance thresholds (53-bit scale)
+static double zigW[ZIG_LAYERS];     // Width of each layer / 2^53
+static double zigF[ZIG_LAYERS];     // exp(-x) at the edge of each layer
 
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
-//double ranf(void);              // Generates random number (double type)
-//double expntl(double x);        // Generate exponentially distributed RV
+//double expntl(ExpStream *es, double x);  // Generate exponentially distributed RV
 
 /*******************************************************************************
-*       ranf()
+*       zigInit()
 ********************************************************************************
-* Function to generate a random double type number. It's implementation depends
-* on the CPU architecture 
+* Function that builds the tables of the exponential ziggurat (Marsaglia and
+* Tsang, 2000), with 53-bit instead of 32-bit abscissas. The tables are shared
+* by every stream (and thread) and are built once before main() starts.
 *******************************************************************************/
-#if CPU==8086
-/*
-This implementation is for Intel 8086/8 and 80286/386 CPUs using
-C compilers with 16-bit short integers and 32-bit long integers.
-*/
-double ranf(void)
+__attribute__((constructor)) void zigInit(void)
 {
-    short *p,*q,k; long Hi,Lo;
-    p=(short *)&SeedTable[strm]; Hi=*(p+1)*A; /* 16807*H->Hi */
-    *(p+1)=0; Lo=SeedTable[strm]*A; /* 16807*L->Lo */
-    p=(short *)&Lo; Hi+=*(p+1); /* add high-order bits of Lo to Hi */
-    q=(short *)&Hi; /* low-order bits of Hi->Lo */
-    *(p+1)=*q&0x7fff; /* clear sign bit */
-    k=*(q+1)<<1; if (*q&0x8000) k++; /* Hi bits 31-45->K */
-    /* form Z + K [- M] (where Z=Lo) : presubtract M to avoid overflow */
-    Lo-=M; Lo+=k; if (Lo<0) Lo+=M;
-    SeedTable[strm]=Lo;
-    return((double)Lo*4.656612875E-10); /* Lo x 1/(2**31-1) */
+    const double m53 = 9007199254740992.0;  // 2^53
+    double de = ZIG_R, te = ZIG_R;
+    double q = ZIG_V / exp(-de);
+
+    zigK[0] = (uint64_t)((de / q) * m53);
+    zigK[1] = 0;
+    zigW[0] = q / m53;
+    zigW[ZIG_LAYERS - 1] = de / m53;
+    zigF[0] = 1.0;
+    zigF[ZIG_LAYERS - 1] = exp(-de);
+    for (int i = ZIG_LAYERS - 2; i >= 1; i--)
+    {
+        de = -log(ZIG_V / de + exp(-de));
+        zigK[i + 1] = (uint64_t)((de / te) * m53);
+        te = de;
+        zigF[i] = exp(-de);
+        zigW[i] = de / m53;
+    }
 }
-#endif
-#if CPU==680000
-double ranf(void)
+
+/*******************************************************************************
+*       zigExp(Rng *rng)
+********************************************************************************
+* Function to generate a unit exponential RV with the ziggurat. The low 8 bits
+* of a draw pick the layer and the top 53 bits the abscissa; about 99% of the
+* draws are accepted with one comparison and one multiplication.
+* - Input: *rng (random stream to draw from)
+* - Output: double (exponential RV of mean 1)
+*******************************************************************************/
+double zigExp(Rng *rng)
 {
-    short *p,*q,k; long Hi,Lo;
-    p=(short *)&SeedTable[strm]; Hi=*(p)*A; /* 16807*H->Hi */
-    *(p)=0; Lo=SeedTable[strm]*A; /* 16807*L->Lo */
-    p=(short *)&Lo; Hi+=*(p); /* add high-order bits of Lo to Hi */
-    q=(short *)&Hi; /* low-order bits of Hi->Lo */
-    *(p)=*(q+1)&0x7fff; /* clear sign bit */
-    k=*(q)<<1; if (*(q+1)&0x8000) k++; /* Hi bits 31-45->K */
-    /* form Z + K [- M] (where Z=Lo) : presubtract M to avoid overflow */
-    Lo-=M; Lo+=k; if (Lo<0) Lo+=M;
-    SeedTable[strm]=Lo;
-    return((double)Lo*4.656612875E-10); /* Lo x 1/(2**31-1) */
+    for (;;)
+    {
+        uint64_t u = rngNext(rng);
+        unsigned int i = u & (ZIG_LAYERS - 1);
+        uint64_t j = u >> 11;
+        double x = j * zigW[i];
+
+        if (j < zigK[i])
+            return x;
+        if (i == 0)         // Tail: memoryless, so restart from ZIG_R
+            return ZIG_R - log(rngUniform(rng));
+        if (zigF[i] + rngUniform(rng) * (zigF[i - 1] - zigF[i]) < exp(-x))
+            return x;
+    }
 }
+
+/*******************************************************************************
+*       expUnit(Rng *rng)
+********************************************************************************
+* Function to generate a unit exponential RV, by the ziggurat or, built with
+* -DEXPNTL_EXACT, by inversion
+* - Input: *rng (random stream to draw from)
+* - Output: double (exponential RV of mean 1)
+*******************************************************************************/
+static inline double expUnit(Rng *rng)
+{
+#ifdef EXPNTL_EXACT
+    return -log(rngUniform(rng));
+#else
+    return zigExp(rng);
 #endif
+}
 
 /*******************************************************************************
-*       expntl(double mean)
+*       expFill(ExpStream *es)
 ********************************************************************************
-* Function to generate exponentially distributed RVs using the inverse method
-* - Input: mean (mean value of distribution)
+* Function that refills the block of a stream with EXP_BLOCK unit variates
+* - Input: *es (stream to refill)
 *******************************************************************************/
-double expntl(double mean)
+void expFill(ExpStream *es)
 {
-    double z; // Uniform random number from 0 to 1
+    for (int i = 0; i < EXP_BLOCK; i++)
+        es->v[i] = expUnit(es->rng);
+    es->next = 0;
+}
 
-    // Pull a uniform RV (interval: 0 < z < 1) using rand()
-    /*
-    do
-    {
-        z = ((double) rand() / RAND_MAX);
-    }
-    while ((z == 0) || (z == 1));
-    return(-mean * log(z));
-    */
-    return (-mean * log( ranf() ) );
+/*******************************************************************************
+*       expInit(ExpStream *es, Rng *rng)
+********************************************************************************
+* Function that attaches a block of exponential variates to a random stream
+* - Input: *es (stream to initialize)
+*           *rng (random stream to draw from, must outlive es)
+*******************************************************************************/
+void expInit(ExpStream *es, Rng *rng)
+{
+    es->rng = rng;
+    es->next = EXP_BLOCK;   // Filled on the first draw
+}
+
+/*******************************************************************************
+*       expntl(ExpStream *es, double mean)
+********************************************************************************
+* Function to generate exponentially distributed RVs, taken from the block of
+* the stream and scaled by the mean
+* - Input: *es (stream to draw from)
+*           mean (mean value of distribution)
+*******************************************************************************/
+static inline double expntl(ExpStream *es, double mean)
+{
+    if (es->next == EXP_BLOCK)
+        expFill(es);
+    return mean * es->v[es->next++];
 }
 
+#endif
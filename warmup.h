@@ -0,0 +1,192 @@
+/*******************************************************************************
+*                    Warm-up Deletion and Batch Means
+********************************************************************************
+* Notes: Output analysis of a single long run. The response time of every
+* customer is averaged in batches of SERIES_BATCH customers (MSER-5 uses
+* batches of 5) and kept in a series of at most SERIES_MAX batch means; when
+* the series is full, adjacent batches are merged two by two, so the memory
+* stays bounded however long the run is.
+*   - MSER (White, 1997): the warm-up is the number d of leading batches that
+*     minimizes the variance of the mean of the remaining ones divided by
+*     their count, searched over the whole series but its last BM_BATCHES.
+*     d is only trusted in the first half of the series: a minimum further
+*     on means the transient is not over yet.
+*   - Batch means: the series is grouped in BM_BATCHES batches, whose means
+*     are nearly independent, and their spread gives the confidence interval
+*     of the mean.
+*------------------------------------------------------------------------------*
+* Usage:
+*   Series z;
+*   seriesInit(&z);
+*   seriesAdd(&z, responseTime);            // on every departure
+*   if (z.n % SERIES_CHECK == 0 && (d = mserTruncation(&z)) < z.n / 2)
+*       seriesDrop(&z, d);                  // warm-up over
+*   seriesEstimate(&z, &e);                 // e.mean +/- estHalfWidth(&e)
+*******************************************************************************/
+#ifndef WARMUP_H
+#define WARMUP_H
+
+#include <stdio.h>              // Needed for printf()
+#include <stdbool.h>            // Needed for bool type
+#include <math.h>               // Needed for fabs() and INFINITY
+#include "replicate.h"          // Needed for Estimate
+
+/*******************************************************************************
+* Defined constants and variables
+*******************************************************************************/
+#define SERIES_BATCH   5        // Customers of a batch at the start (MSER-5)
+#define SERIES_MAX     4096     // Maximum number of batch means kept
+#define SERIES_CHECK   512      // Batches between two precision checks
+#define SERIES_SEGMENT 128      // Batches between two restart points of a warm-up
+#define BM_BATCHES     32       // Batches of the batch means interval
+
+typedef struct Series {         // Batch means of an output, oldest first
+    double z[SERIES_MAX];       // Mean of each complete batch
+    int n;                      // Number of complete batches
+    unsigned long size;         // Customers per batch
+    unsigned long count;        // Customers in the current batch
+    double sum;                 // Sum of the current batch
+} Series;
+
+/*******************************************************************************
+*       seriesInit(Series *z)
+********************************************************************************
+* Function that empties a series and sets its batches back to SERIES_BATCH
+* customers
+* - Input: *z (series to initialize)
+*******************************************************************************/
+void seriesInit(Series *z)
+{
+    z->n = 0;
+    z->size = SERIES_BATCH;
+    z->count = 0;
+    z->sum = 0.0;
+}
+
+/*******************************************************************************
+*       seriesAdd(Series *z, double value)
+********************************************************************************
+* Function that adds the output of one customer to the current batch. When a
+* batch is complete and the series is already full, adjacent batch means are
+* merged first (the batches double in size).
+* - Input: *z (series to update)
+*           value (output of the customer)
+* - Output: bool (true if a batch has just been completed)
+*******************************************************************************/
+static inline bool seriesAdd(Series *z, double value)
+{
+    z->sum += value;
+    if (++z->count < z->size)
+        return false;
+
+    if (z->n == SERIES_MAX)
+    {
+        for (int i = 0; i < SERIES_MAX / 2; i++)
+            z->z[i] = 0.5 * (z->z[2 * i] + z->z[2 * i + 1]);
+        z->n = SERIES_MAX / 2;
+        z->size *= 2;
+        if (z->count < z->size)
+            return false;
+    }
+    z->z[z->n++] = z->sum / z->count;
+    z->count = 0;
+    z->sum = 0.0;
+    return true;
+}
+
+/*******************************************************************************
+*       mserTruncation(const Series *z)
+********************************************************************************
+* Function that returns the MSER truncation point of a series: the d that
+* minimizes sum((z[i] - mean(z[d..n)))^2) / (n - d)^2 over i >= d, for d up
+* to n - BM_BATCHES (the smallest d of a tie). Computed in O(n) from suffix
+* sums.
+* - Input: *z (series of batch means)
+* - Output: int (number of leading batches to delete, n if the series is
+*           shorter than BM_BATCHES)
+*******************************************************************************/
+int mserTruncation(const Series *z)
+{
+    double sum = 0.0, sumSq = 0.0;
+    double best = INFINITY;
+    int bestD = z->n;
+
+    for (int d = z->n - 1; d >= 0; d--)
+    {
+        int m = z->n - d;
+        sum += z->z[d];
+        sumSq += z->z[d] * z->z[d];
+        if (m >= BM_BATCHES)
+        {
+            double ss = sumSq - sum * sum / m;
+            double stat = ss / ((double)m * m);
+            if (stat <= best)
+            {
+                best = stat;
+                bestD = d;
+            }
+        }
+    }
+    return bestD;
+}
+
+/*******************************************************************************
+*       seriesDrop(Series *z, int d)
+********************************************************************************
+* Function that deletes the d oldest batches of a series (the warm-up)
+* - Input: *z (series to update)
+*           d (number of leading batches to delete)
+*******************************************************************************/
+void seriesDrop(Series *z, int d)
+{
+    for (int i = d; i < z->n; i++)
+        z->z[i - d] = z->z[i];
+    z->n -= d;
+}
+
+/*******************************************************************************
+*       seriesEstimate(const Series *z, Estimate *e)
+********************************************************************************
+* Function that estimates the mean of a series by batch means: the complete
+* batches are grouped in BM_BATCHES groups (the oldest ones left over are
+* dropped) and each group mean is one observation of *e
+* - Input: *z (series of batch means)
+* - Output: *e (estimate of the mean, e->n < 2 if the series is too short)
+*******************************************************************************/
+void seriesEstimate(const Series *z, Estimate *e)
+{
+    int per = z->n / BM_BATCHES;
+
+    estInit(e);
+    if (per == 0)
+        return;
+    for (int b = 0; b < BM_BATCHES; b++)
+    {
+        const double *group = &z->z[z->n - (BM_BATCHES - b) * per];
+        double sum = 0.0;
+        for (int i = 0; i < per; i++)
+            sum += group[i];
+        estAdd(e, sum / per);
+    }
+}
+
+/*******************************************************************************
+*       seriesPrecise(const Series *z, double precision)
+********************************************************************************
+* Function that tells whether the batch means interval of the mean is
+* narrower than precision times the mean
+* - Input: *z (series of batch means)
+*           precision (target relative half width, e.g. 0.01)
+* - Output: bool (true if the target is met)
+*******************************************************************************/
+bool seriesPrecise(const Series *z, double precision)
+{
+    Estimate e;
+
+    seriesEstimate(z, &e);
+    if (e.n < BM_BATCHES)
+        return false;
+    return estHalfWidth(&e) <= precision * fabs(e.mean);
+}
+
+#endif
@@ -5,21 +5,33 @@
 # Description: This script runs the M/M/c model for different values 
 # of lambda, # μ and c. It saves the output to a directory passed as 
 # an argument.
+# Every combination is run by a single mmc process (sweep mode), which
+# writes one CSV row per point to <dir>/sweep.csv (times in seconds).
 #-------------------------------------------------------------------
 # Execution: 
-# ./wrapper lambda:min,max,step mean:min,max,step c:min,max,step
-# ./wrapper 0.010,0.00  1:10:1
+# ./wrapper.sh <arrivals> <service> <servers> <dir> [mmc options]
+#   each of <arrivals> <service> <servers> is a value, a list
+#   x1,x2,... or a range min:max:step (times in us)
+# ./wrapper.sh 10:50:10 20 1:10:1 results -s 1e8 -R 8
 #-------------------------------------------------------------------
 
 
-if [[ -z $1 || -z $2 || -z $3 ]]; then 
-    echo "Usage: ./wrapper.sh <runs> <duration>"
+if [[ -z $1 || -z $2 || -z $3 || -z $4 ]]; then 
+    echo "Usage: ./wrapper.sh <arrivals> <service> <servers> <dir> [mmc options]"
     exit;
 fi
 
+arrivals=$1
+service=$2
+servers=$3
+dir=$4
+shift 4
 
+MMC=${MMC:-./mmc}
+if [[ ! -x $MMC ]]; then
+    gcc -O2 -o mmc mmc.c -lm -lpthread || exit 1
+    MMC=./mmc
+fi
 
-
-
-
-
+mkdir -p "$dir"
+$MMC -a "$arrivals" -d "$service" -c "$servers" -o "$dir/sweep.csv" "$@"